@@ -24,7 +24,8 @@ CLI_ARGS: dict[Sequence[str], dict[str, Any]] = {
     ("-h", "--host"): dict(
         type=str,
         required=True,
-        help='The address of the server (e.g., "localhost")',
+        help='The address of the server (e.g., "localhost", '
+        'or "unix:/tmp/zappy.sock" for a server started with -U)',
     ),
     ("-a", "--help"): dict(
         action="help",
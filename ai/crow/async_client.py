@@ -16,7 +16,7 @@ class AsyncSocketClient:
     ):
         self._host = host
         self._port = port
-        self._sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self._sock = self._open_socket()
         self._sock.setblocking(False)
         self._loop = asyncio.get_event_loop()
 
@@ -28,10 +28,16 @@ class AsyncSocketClient:
         self._broadcast_callback = broadcast_callback
 
     async def connect(self):
-        await self._loop.sock_connect(self._sock, (self._host, self._port))
+        await self._loop.sock_connect(self._sock, self._address())
         self._connected = True
         self._recv_task = asyncio.create_task(self._receiver_loop())
 
+    def _open_socket(self) -> socket.socket:
+        return socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+
+    def _address(self):
+        return (self._host, self._port)
+
     async def send_command(self, command: str) -> str:
         async with self.command_lock:
             if not self._connected:
@@ -92,3 +98,23 @@ class AsyncSocketClient:
         if self._recv_task:
             self._recv_task.cancel()
         self._sock.close()
+
+
+class AsyncUnixSocketClient(AsyncSocketClient):
+    """
+    Same protocol over the Unix socket of a server started with -U, for the
+    AIs running on the server host.
+    """
+
+    def __init__(
+        self,
+        path: str,
+        broadcast_callback: Optional[Callable] = None,
+    ):
+        super().__init__(path, 0, broadcast_callback)
+
+    def _open_socket(self) -> socket.socket:
+        return socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+
+    def _address(self):
+        return self._host
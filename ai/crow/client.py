@@ -1,9 +1,11 @@
 from functools import partial
 
-from ai.crow.async_client import AsyncSocketClient
+from ai.crow.async_client import AsyncSocketClient, AsyncUnixSocketClient
 
 from .command_manager import CommandManager
 
+UNIX_PREFIX = "unix:"
+
 
 class Client(CommandManager):
     _broadcast_receiver_callback = None
@@ -13,7 +15,8 @@ class Client(CommandManager):
         Initializes the client with the specified host and port.
 
         Args:
-            host (str): The hostname or IP address to connect to.
+            host (str): The hostname or IP address to connect to, or
+                "unix:<path>" for the Unix socket of a local server.
             port (int): The port number to connect to.
 
         The constructor sets up an asynchronous socket client using the provided host and port.
@@ -24,7 +27,11 @@ class Client(CommandManager):
         if self._broadcast_receiver_callback is not None:
             __callback = self._broadcast_receiver_callback
 
-        socket = AsyncSocketClient(host, port, __callback or (lambda *_: _))
+        __callback = __callback or (lambda *_: _)
+        if host.startswith(UNIX_PREFIX):
+            socket = AsyncUnixSocketClient(host.removeprefix(UNIX_PREFIX), __callback)
+        else:
+            socket = AsyncSocketClient(host, port, __callback)
         super().__init__(sock=socket)
 
     async def connect(self, team: str):
@@ -0,0 +1,128 @@
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "loadgen.h"
+
+static const char LOADGEN_USAGE[] = {
+    "Usage: ./zappy_loadgen -n <team1> ... [OPTIONS]\n"
+    "Options:\n"
+    "  -a, --address <host>      server address (default: 127.0.0.1)\n"
+    "                            or unix:<path> for a server's -U socket\n"
+    "  -p, --port <port>         server port (default: 4242)\n"
+    "  -n, --names <team1> ...   teams to join, in turn\n"
+    "  -c, --clients <num>       simulated players (default: 1000)\n"
+    "  -w, --window <num>        commands in flight per player (default: 1)\n"
+    "  -f, --freq <frequency>    frequency the server runs at (default: 100)\n"
+    "  -d, --duration <sec>      length of the measure (default: 10)\n"
+    "  -m, --mix <name>          look, broadcast, fork or mixed\n"
+    "                            (default: mixed)\n"
+    "  -s, --seed <num>          seed of the command sequence (default: 42)\n"
+    "  -l, --label <text>        copied to the results, e.g. a commit id\n"
+};
+
+static const char SHORT_OPTIONS[] = "a:p:n:c:w:f:d:m:s:l:";
+
+static const struct option LONG_OPTIONS[] = {
+    {"address", required_argument, nullptr, 'a'},
+    {"port", required_argument, nullptr, 'p'},
+    {"names", required_argument, nullptr, 'n'},
+    {"clients", required_argument, nullptr, 'c'},
+    {"window", required_argument, nullptr, 'w'},
+    {"freq", required_argument, nullptr, 'f'},
+    {"duration", required_argument, nullptr, 'd'},
+    {"mix", required_argument, nullptr, 'm'},
+    {"seed", required_argument, nullptr, 's'},
+    {"label", required_argument, nullptr, 'l'},
+    {nullptr, 0, nullptr, 0}
+};
+
+static
+bool parse_number(const char *arg, uint64_t max, uint32_t *out)
+{
+    char *end;
+    unsigned long long value = strtoull(arg, &end, 10);
+
+    if (*arg == '\0' || *end != '\0' || value == 0 || value > max)
+        return fprintf(stderr, "Invalid value: %s (must be between 1 and "
+            "%lu)\n", arg, max), false;
+    *out = value;
+    return true;
+}
+
+static
+bool parse_teams(bench_params_t *params, char *argv[])
+{
+    for (optind--; argv[optind] != nullptr && *argv[optind] != '-';
+        optind++) {
+        if (params->team_count == LOADGEN_TEAM_MAX)
+            return fprintf(stderr, "Too many teams\n"), false;
+        params->teams[params->team_count] = argv[optind];
+        params->team_count++;
+    }
+    return params->team_count != 0;
+}
+
+static
+bool text_arg_dispatcher(bench_params_t *params, char *argv[], int opt)
+{
+    switch (opt) {
+        case 'a':
+            params->host = optarg;
+            return true;
+        case 'l':
+            params->label = optarg;
+            return true;
+        case 'n':
+            return parse_teams(params, argv);
+        case 'm':
+            params->mix = bench_mix_from_name(optarg);
+            return params->mix != MIX_COUNT
+                || (fprintf(stderr, "Unknown mix: %s\n", optarg), false);
+        default:
+            return fprintf(stderr, "%s", LOADGEN_USAGE), false;
+    }
+}
+
+static
+bool arg_dispatcher(bench_params_t *params, char *argv[], int opt)
+{
+    uint32_t value = 0;
+
+    switch (opt) {
+        case 'p':
+            return parse_number(optarg, UINT16_MAX, &value)
+                && (params->port = value, true);
+        case 'c':
+            return parse_number(optarg, 1 << 20, &params->clients);
+        case 'w':
+            return parse_number(optarg, LOADGEN_WINDOW_MAX, &params->window);
+        case 'f':
+            return parse_number(optarg, 1000000, &params->frequency);
+        case 'd':
+            return parse_number(optarg, 86400, &params->duration_sec);
+        case 's':
+            return parse_number(optarg, UINT32_MAX, &value)
+                && (params->seed = value, true);
+        default:
+            return text_arg_dispatcher(params, argv, opt);
+    }
+}
+
+bool bench_parse_args(bench_params_t *params, int argc, char *argv[])
+{
+    *params = (bench_params_t){ .host = "127.0.0.1", .label = "",
+        .port = 4242, .clients = 1000, .window = 1, .frequency = 100,
+        .duration_sec = 10, .seed = 42, .mix = MIX_MIXED };
+    for (int opt;;) {
+        opt = getopt_long(argc, argv, SHORT_OPTIONS, LONG_OPTIONS, nullptr);
+        if (opt < 0)
+            break;
+        if (!arg_dispatcher(params, argv, opt))
+            return false;
+    }
+    if (params->team_count != 0)
+        return true;
+    fprintf(stderr, "Missing team names\n%s", LOADGEN_USAGE);
+    return false;
+}
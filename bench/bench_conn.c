@@ -0,0 +1,111 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "loadgen.h"
+
+static constexpr const uint64_t SEED_SPREAD = 0x9E3779B97F4A7C15ULL;
+
+static constexpr const char UNIX_PREFIX[] = "unix:";
+
+/**
+ * @brief Resolves the -a address: an IPv4 address, or "unix:<path>" for the
+ * Unix socket of a server started with -U.
+ */
+static
+socklen_t bench_address(const bench_params_t *p, struct sockaddr_storage *ss)
+{
+    struct sockaddr_in *sin = (struct sockaddr_in *)ss;
+    struct sockaddr_un *sun = (struct sockaddr_un *)ss;
+    const char *path = p->host + sizeof UNIX_PREFIX - 1;
+
+    if (strncmp(p->host, UNIX_PREFIX, sizeof UNIX_PREFIX - 1) == 0) {
+        if (strlen(path) >= sizeof sun->sun_path)
+            return 0;
+        sun->sun_family = AF_UNIX;
+        strcpy(sun->sun_path, path);
+        return sizeof *sun;
+    }
+    sin->sin_family = AF_INET;
+    sin->sin_port = htons(p->port);
+    if (inet_pton(AF_INET, p->host, &sin->sin_addr) != 1)
+        return 0;
+    return sizeof *sin;
+}
+
+static
+int open_socket(const struct sockaddr_storage *ss, socklen_t len)
+{
+    int fd = socket(ss->ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int one = 1;
+
+    if (fd < 0)
+        return -1;
+    if (ss->ss_family == AF_INET)
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    if (connect(fd, (const struct sockaddr *)ss, len) < 0)
+        return close(fd), -1;
+    return fd;
+}
+
+bool bench_connect_all(bench_t *bench)
+{
+    struct sockaddr_storage ss = { };
+    socklen_t len = bench_address(&bench->params, &ss);
+
+    if (len == 0)
+        return fprintf(stderr, "Invalid address %s\n", bench->params.host),
+            false;
+    bench->conns = calloc(bench->params.clients, sizeof *bench->conns);
+    bench->pfds = calloc(bench->params.clients, sizeof *bench->pfds);
+    if (bench->conns == nullptr || bench->pfds == nullptr)
+        return perror("Can't allocate the players"), false;
+    for (uint32_t i = 0; i < bench->params.clients; i++) {
+        bench->pfds[i] = (struct pollfd){ .fd = open_socket(&ss, len),
+            .events = POLLIN };
+        if (bench->pfds[i].fd < 0)
+            return perror("Can't connect"), false;
+        bench->conns[i].rng = (bench->params.seed + i + 1) * SEED_SPREAD;
+        bench->pending++;
+    }
+    return true;
+}
+
+void bench_conn_close(bench_t *bench, uint32_t idx)
+{
+    bench_conn_t *conn = bench->conns + idx;
+
+    if (conn->state == CONN_CLOSED)
+        return;
+    bench->pending -= conn->state != CONN_READY;
+    bench->alive -= conn->state == CONN_READY;
+    conn->state = CONN_CLOSED;
+    close(bench->pfds[idx].fd);
+    bench->pfds[idx].fd = -1;
+}
+
+void bench_conn_feed(bench_t *bench, uint32_t idx)
+{
+    bench_conn_t *conn = bench->conns + idx;
+    const bench_command_t *cmd;
+    size_t slot;
+
+    while (bench->sending && conn->state == CONN_READY
+        && conn->inflight < bench->params.window) {
+        cmd = bench_next_command(bench->params.mix, &conn->rng);
+        if (send(bench->pfds[idx].fd, cmd->line, strlen(cmd->line),
+            MSG_DONTWAIT | MSG_NOSIGNAL) < 0)
+            return;
+        slot = (conn->head + conn->inflight) % LOADGEN_WINDOW_MAX;
+        conn->sent_at[slot] = bench_now();
+        conn->units[slot] = cmd->units;
+        conn->inflight++;
+        bench->stats.sent++;
+    }
+}
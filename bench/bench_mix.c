@@ -0,0 +1,77 @@
+#include <string.h>
+
+#include "utils/common_macros.h"
+
+#include "loadgen.h"
+
+typedef struct {
+    const char *name;
+    const bench_command_t *commands;
+    size_t count;
+} mix_table_t;
+
+/** Commands are repeated to weight them; eggs and objects may be missing,
+so some Take and Set are answered ko, as they would be in a real game. **/
+
+static const bench_command_t LOOK_HEAVY[] = {
+    {"Look\n", 7}, {"Look\n", 7}, {"Look\n", 7}, {"Look\n", 7},
+    {"Look\n", 7}, {"Look\n", 7}, {"Forward\n", 7}, {"Right\n", 7},
+};
+
+static const bench_command_t BROADCAST_HEAVY[] = {
+    {"Broadcast bench\n", 7}, {"Broadcast bench\n", 7},
+    {"Broadcast bench\n", 7}, {"Broadcast bench\n", 7},
+    {"Broadcast bench\n", 7}, {"Forward\n", 7}, {"Left\n", 7},
+    {"Inventory\n", 1},
+};
+
+static const bench_command_t FORK_HEAVY[] = {
+    {"Fork\n", 42}, {"Fork\n", 42}, {"Fork\n", 42}, {"Fork\n", 42},
+    {"Forward\n", 7}, {"Inventory\n", 1}, {"Connect_nbr\n", 0},
+    {"Right\n", 7},
+};
+
+static const bench_command_t MIXED[] = {
+    {"Forward\n", 7}, {"Forward\n", 7}, {"Forward\n", 7}, {"Left\n", 7},
+    {"Right\n", 7}, {"Look\n", 7}, {"Look\n", 7}, {"Inventory\n", 1},
+    {"Broadcast bench\n", 7}, {"Connect_nbr\n", 0}, {"Fork\n", 42},
+    {"Eject\n", 7}, {"Take food\n", 7}, {"Set food\n", 7},
+};
+
+static const mix_table_t MIXES[MIX_COUNT] = {
+    [MIX_LOOK] = {"look", LOOK_HEAVY, LENGTH_OF(LOOK_HEAVY)},
+    [MIX_BROADCAST] = {"broadcast", BROADCAST_HEAVY,
+        LENGTH_OF(BROADCAST_HEAVY)},
+    [MIX_FORK] = {"fork", FORK_HEAVY, LENGTH_OF(FORK_HEAVY)},
+    [MIX_MIXED] = {"mixed", MIXED, LENGTH_OF(MIXED)},
+};
+
+/**
+ * @brief xorshift64*, the state must never be zero.
+ */
+static
+uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+const bench_command_t *bench_next_command(bench_mix_t mix, uint64_t *rng)
+{
+    return &MIXES[mix].commands[next_random(rng) % MIXES[mix].count];
+}
+
+bench_mix_t bench_mix_from_name(const char *name)
+{
+    for (size_t i = 0; i < MIX_COUNT; i++)
+        if (!strcmp(MIXES[i].name, name))
+            return i;
+    return MIX_COUNT;
+}
+
+const char *bench_mix_name(bench_mix_t mix)
+{
+    return MIXES[mix].name;
+}
@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include "utils/common_macros.h"
+
+#include "loadgen.h"
+
+static const char *UNSOLICITED_PREFIXES[] = {
+    "message ", "eject: ", "Elevation underway", "Current level: ",
+};
+
+static
+bool is_unsolicited(const char *line)
+{
+    for (size_t i = 0; i < LENGTH_OF(UNSOLICITED_PREFIXES); i++)
+        if (!strncmp(line, UNSOLICITED_PREFIXES[i],
+            strlen(UNSOLICITED_PREFIXES[i])))
+            return true;
+    return false;
+}
+
+static
+void record_reply(bench_t *bench, bench_conn_t *conn, const char *line)
+{
+    uint64_t latency = bench_now() - conn->sent_at[conn->head];
+    uint64_t nominal = (uint64_t)conn->units[conn->head] * 1000000
+        / bench->params.frequency;
+
+    histogram_record(&bench->stats.latency, latency);
+    histogram_record(&bench->stats.overhead,
+        (latency > nominal) ? latency - nominal : 0);
+    bench->stats.replies++;
+    bench->stats.ko += !strcmp(line, "ko");
+    conn->head = (conn->head + 1) % LOADGEN_WINDOW_MAX;
+    conn->inflight--;
+}
+
+static
+void join_team(bench_t *bench, uint32_t idx)
+{
+    const char *team = bench->params.teams[idx % bench->params.team_count];
+    char line[LOADGEN_LINE_MAX];
+    int len = snprintf(line, sizeof line, "%s\n", team);
+
+    send(bench->pfds[idx].fd, line, len, MSG_NOSIGNAL);
+    bench->conns[idx].state = CONN_SLOTS;
+}
+
+static
+void handle_reply(bench_t *bench, uint32_t idx, const char *line)
+{
+    bench_conn_t *conn = bench->conns + idx;
+
+    if (!strcmp(line, "dead")) {
+        bench->stats.deaths++;
+        bench_conn_close(bench, idx);
+        return;
+    }
+    if (is_unsolicited(line) || conn->inflight == 0)
+        return;
+    record_reply(bench, conn, line);
+    bench_conn_feed(bench, idx);
+}
+
+static
+void player_joined(bench_t *bench, uint32_t idx)
+{
+    bench->conns[idx].state = CONN_READY;
+    bench->pending--;
+    bench->joined++;
+    bench->alive++;
+    bench_conn_feed(bench, idx);
+}
+
+static
+void handle_handshake(bench_t *bench, uint32_t idx, const char *line)
+{
+    bench_conn_t *conn = bench->conns + idx;
+
+    if (conn->state == CONN_WELCOME) {
+        join_team(bench, idx);
+        return;
+    }
+    if (conn->state == CONN_SLOTS && !strcmp(line, "ko")) {
+        bench->stats.rejected++;
+        bench_conn_close(bench, idx);
+        return;
+    }
+    if (conn->state == CONN_SLOTS) {
+        conn->state = CONN_SIZE;
+        return;
+    }
+    player_joined(bench, idx);
+}
+
+void bench_conn_line(bench_t *bench, uint32_t idx, const char *line)
+{
+    if (bench->conns[idx].state == CONN_READY)
+        handle_reply(bench, idx, line);
+    else if (bench->conns[idx].state != CONN_CLOSED)
+        handle_handshake(bench, idx, line);
+}
@@ -0,0 +1,49 @@
+#include <stdio.h>
+
+#include "loadgen.h"
+
+static
+void print_string(FILE *stream, const char *key, const char *value)
+{
+    fprintf(stream, "\"%s\":\"", key);
+    for (; *value != '\0'; value++) {
+        if (*value == '"' || *value == '\\')
+            fputc('\\', stream);
+        if ((unsigned char)*value >= ' ')
+            fputc(*value, stream);
+    }
+    fputs("\",", stream);
+}
+
+static
+void print_quantiles(FILE *stream, const char *key, const histogram_t *hist)
+{
+    fprintf(stream, "\"%s\":{\"p50\":%lu,\"p90\":%lu,\"p99\":%lu,"
+        "\"p999\":%lu,\"max\":%lu,\"mean\":%.1f}", key,
+        histogram_quantile(hist, 0.5), histogram_quantile(hist, 0.9),
+        histogram_quantile(hist, 0.99), histogram_quantile(hist, 0.999),
+        hist->max, hist->count ? (double)hist->sum / hist->count : 0.);
+}
+
+void bench_report(const bench_t *bench, FILE *stream)
+{
+    const bench_stats_t *st = &bench->stats;
+    double elapsed = (double)(bench->finished_at - bench->connected_at) / 1e6;
+
+    fputc('{', stream);
+    print_string(stream, "label", bench->params.label);
+    print_string(stream, "mix", bench_mix_name(bench->params.mix));
+    fprintf(stream, "\"frequency\":%u,\"clients\":%u,\"window\":%u,"
+        "\"seed\":%lu,\"joined\":%u,\"rejected\":%lu,\"handshake_s\":%.3f,"
+        "\"duration_s\":%.3f,\"sent\":%lu,\"replies\":%lu,\"ko\":%lu,"
+        "\"deaths\":%lu,\"throughput_rps\":%.1f,", bench->params.frequency,
+        bench->params.clients, bench->params.window, bench->params.seed,
+        bench->joined, st->rejected,
+        (double)(bench->connected_at - bench->started_at) / 1e6, elapsed,
+        st->sent, st->replies, st->ko, st->deaths,
+        (elapsed > 0) ? (double)st->replies / elapsed : 0.);
+    print_quantiles(stream, "latency_us", &st->latency);
+    fputc(',', stream);
+    print_quantiles(stream, "overhead_us", &st->overhead);
+    fputs("}\n", stream);
+}
@@ -0,0 +1,89 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include "loadgen.h"
+
+static constexpr const uint64_t HANDSHAKE_TIMEOUT_US = 30000000;
+static constexpr const int POLL_STEP_MS = 100;
+
+static
+void split_lines(bench_t *bench, uint32_t idx)
+{
+    bench_conn_t *conn = bench->conns + idx;
+    char *start = conn->in;
+    char *nl = memchr(start, '\n', conn->in_len);
+
+    for (; nl != nullptr && conn->state != CONN_CLOSED;
+        nl = memchr(start, '\n', conn->in + conn->in_len - start)) {
+        *nl = '\0';
+        bench_conn_line(bench, idx, start);
+        start = nl + 1;
+    }
+    conn->in_len -= start - conn->in;
+    memmove(conn->in, start, conn->in_len);
+    if (conn->in_len == LOADGEN_LINE_MAX)
+        conn->in_len = 0;
+}
+
+static
+void read_conn(bench_t *bench, uint32_t idx)
+{
+    bench_conn_t *conn = bench->conns + idx;
+    ssize_t got = recv(bench->pfds[idx].fd, conn->in + conn->in_len,
+        LOADGEN_LINE_MAX - conn->in_len, MSG_DONTWAIT);
+
+    if (got == 0 || (got < 0 && errno != EAGAIN && errno != EINTR)) {
+        bench_conn_close(bench, idx);
+        return;
+    }
+    if (got < 0)
+        return;
+    conn->in_len += got;
+    split_lines(bench, idx);
+}
+
+static
+void poll_round(bench_t *bench, int timeout)
+{
+    int events = poll(bench->pfds, bench->params.clients, timeout);
+
+    if (events < 0 && errno != EINTR)
+        perror("poll failed");
+    for (uint32_t i = 0; events > 0 && i < bench->params.clients; i++) {
+        if (bench->pfds[i].revents == 0)
+            continue;
+        events--;
+        read_conn(bench, i);
+    }
+}
+
+static
+void start_load(bench_t *bench)
+{
+    bench->connected_at = bench_now();
+    bench->stop_at = bench->connected_at
+        + (uint64_t)bench->params.duration_sec * 1000000;
+    bench->sending = true;
+    fprintf(stderr, "%u/%u players joined in %.3f s, loading for %u s\n",
+        bench->joined, bench->params.clients,
+        (double)(bench->connected_at - bench->started_at) / 1e6,
+        bench->params.duration_sec);
+    for (uint32_t i = 0; i < bench->params.clients; i++)
+        bench_conn_feed(bench, i);
+}
+
+void bench_run(bench_t *bench)
+{
+    uint64_t now = bench_now();
+    uint64_t deadline = now + HANDSHAKE_TIMEOUT_US;
+
+    for (; bench->pending > 0 && now < deadline; now = bench_now())
+        poll_round(bench, POLL_STEP_MS);
+    start_load(bench);
+    for (now = bench_now(); now < bench->stop_at && bench->alive > 0;
+        now = bench_now())
+        poll_round(bench, (bench->stop_at - now + 999) / 1000);
+    bench->finished_at = (now < bench->stop_at) ? now : bench->stop_at;
+}
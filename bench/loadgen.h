@@ -0,0 +1,174 @@
+#ifndef LOADGEN_H_
+    #define LOADGEN_H_
+
+    #include <poll.h>
+    #include <stddef.h>
+    #include <stdint.h>
+    #include <stdio.h>
+    #include <sys/time.h>
+
+    #include "metrics/metrics.h"
+
+/**
+ * @brief Most commands a simulated player keeps in flight, the server
+ * dropping anything past its own limit.
+ */
+static constexpr const size_t LOADGEN_WINDOW_MAX = 10;
+static constexpr const size_t LOADGEN_LINE_MAX = 8192;
+static constexpr const size_t LOADGEN_TEAM_MAX = 256;
+
+typedef enum {
+    MIX_LOOK,
+    MIX_BROADCAST,
+    MIX_FORK,
+    MIX_MIXED,
+    MIX_COUNT
+} bench_mix_t;
+
+typedef struct {
+    const char *line; // Sent as is, newline included
+    uint16_t units; // Time units the server is expected to take
+} bench_command_t;
+
+typedef enum {
+    CONN_WELCOME, // Waiting for the greeting
+    CONN_SLOTS, // Team name sent, waiting for the remaining slots
+    CONN_SIZE, // Waiting for the map size
+    CONN_READY,
+    CONN_CLOSED
+} bench_conn_state_t;
+
+/**
+ * @brief One simulated player; replies are matched to the oldest command
+ * in flight, the server answering in order.
+ */
+typedef struct {
+    bench_conn_state_t state;
+    uint64_t rng; // Each player has its own command sequence
+    uint8_t head;
+    uint8_t inflight;
+    uint64_t sent_at[LOADGEN_WINDOW_MAX];
+    uint16_t units[LOADGEN_WINDOW_MAX];
+    size_t in_len;
+    char in[LOADGEN_LINE_MAX];
+} bench_conn_t;
+
+typedef struct {
+    const char *host;
+    const char *label;
+    const char *teams[LOADGEN_TEAM_MAX];
+    size_t team_count;
+    uint16_t port;
+    uint32_t clients;
+    uint32_t window;
+    uint32_t frequency;
+    uint32_t duration_sec;
+    uint64_t seed;
+    bench_mix_t mix;
+} bench_params_t;
+
+typedef struct {
+    uint64_t sent;
+    uint64_t replies;
+    uint64_t ko;
+    uint64_t deaths;
+    uint64_t rejected;
+    histogram_t latency; // From the send to the reply, in microseconds
+    histogram_t overhead; // Latency minus the time the command should take
+} bench_stats_t;
+
+typedef struct {
+    bench_params_t params;
+    bench_conn_t *conns;
+    struct pollfd *pfds;
+    uint32_t pending; // Still in the handshake
+    uint32_t joined;
+    uint32_t alive;
+    bool sending;
+    uint64_t started_at;
+    uint64_t connected_at;
+    uint64_t stop_at;
+    uint64_t finished_at;
+    bench_stats_t stats;
+} bench_t;
+
+/**
+ * @brief Same clock as the server's, in microseconds.
+ */
+static inline
+uint64_t bench_now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, nullptr);
+    return (uint64_t)tv.tv_sec * 1000000 + (uint64_t)tv.tv_usec;
+}
+
+/**
+ * @brief Fills the parameters from the command line, printing the usage on
+ * error.
+ *
+ * @param params
+ * @param argc
+ * @param argv
+ * @return false on invalid arguments
+ */
+bool bench_parse_args(bench_params_t *params, int argc, char *argv[]);
+
+/**
+ * @brief Picks the next command of the mix.
+ *
+ * @param mix
+ * @param rng State of the player's generator, never zero.
+ * @return const bench_command_t*
+ */
+const bench_command_t *bench_next_command(bench_mix_t mix, uint64_t *rng);
+/**
+ * @brief Looks up a mix by name.
+ *
+ * @param name
+ * @return bench_mix_t MIX_COUNT if unknown
+ */
+bench_mix_t bench_mix_from_name(const char *name);
+const char *bench_mix_name(bench_mix_t mix);
+
+/**
+ * @brief Opens every connection; they are driven by bench_run afterwards.
+ *
+ * @param bench
+ * @return false if a socket could not be opened
+ */
+bool bench_connect_all(bench_t *bench);
+/**
+ * @brief Handles a complete line received on a connection.
+ *
+ * @param bench
+ * @param idx
+ * @param line Nul terminated, newline excluded
+ */
+void bench_conn_line(bench_t *bench, uint32_t idx, const char *line);
+/**
+ * @brief Fills the connection's window with new commands.
+ *
+ * @param bench
+ * @param idx
+ */
+void bench_conn_feed(bench_t *bench, uint32_t idx);
+void bench_conn_close(bench_t *bench, uint32_t idx);
+
+/**
+ * @brief Runs the handshakes, then the load for the configured duration.
+ *
+ * @param bench
+ */
+void bench_run(bench_t *bench);
+
+/**
+ * @brief Prints the results as a single JSON line.
+ *
+ * @param bench
+ * @param stream
+ */
+void bench_report(const bench_t *bench, FILE *stream);
+
+#endif /* !LOADGEN_H_ */
@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "loadgen.h"
+
+static constexpr const int EXIT_TEK_FAILURE = 84;
+static constexpr const rlim_t SPARE_FDS = 16;
+
+/**
+ * @brief Thousands of players need as many descriptors, which is above the
+ * usual soft limit.
+ */
+static
+void raise_fd_limit(uint32_t clients)
+{
+    struct rlimit lim;
+
+    if (getrlimit(RLIMIT_NOFILE, &lim) < 0
+        || lim.rlim_cur >= clients + SPARE_FDS)
+        return;
+    lim.rlim_cur = (lim.rlim_max < clients + SPARE_FDS)
+        ? lim.rlim_max : clients + SPARE_FDS;
+    if (setrlimit(RLIMIT_NOFILE, &lim) < 0 || lim.rlim_cur < clients)
+        fprintf(stderr, "Descriptor limit is too low for %u players\n",
+            clients);
+}
+
+static
+void bench_destroy(bench_t *bench)
+{
+    for (uint32_t i = 0; bench->pfds != nullptr
+        && i < bench->params.clients; i++)
+        if (bench->pfds[i].fd > 0)
+            close(bench->pfds[i].fd);
+    free(bench->pfds);
+    free(bench->conns);
+}
+
+int main(int argc, char *argv[])
+{
+    bench_t bench = { };
+
+    if (!bench_parse_args(&bench.params, argc, argv))
+        return EXIT_TEK_FAILURE;
+    raise_fd_limit(bench.params.clients);
+    bench.started_at = bench_now();
+    if (!bench_connect_all(&bench)) {
+        bench_destroy(&bench);
+        return EXIT_TEK_FAILURE;
+    }
+    bench_run(&bench);
+    bench_report(&bench, stdout);
+    bench_destroy(&bench);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "client/client.h"
+#include "game_events/incantation.h"
+#include "server.h"
+
+#include "microbench.h"
+
+/** The check of an incantation, before and after the tile index: a loop over
+the stones then a scan of every player, against a vector compare then a
+lookup. The world is a 32 x 32 map with a thousand players, the tiles being
+visited in turn at every tier. **/
+
+static constexpr const size_t SIDE = 32;
+static constexpr const size_t PLAYER_COUNT = 1000;
+
+static server_t WORLD;
+static client_state_t PLAYERS[PLAYER_COUNT];
+
+static
+void fill_world(void)
+{
+    srand(42);
+    memset(WORLD.tile_players, 0, sizeof WORLD.tile_players);
+    for (size_t y = 0; y < SIDE; y++)
+        for (size_t x = 0; x < SIDE; x++)
+            for (size_t i = 0; i < RES_COUNT; i++)
+                WORLD.map[y][x].qnts[i] = rand() % 4;
+    for (size_t i = 0; i < PLAYER_COUNT; i++) {
+        PLAYERS[i] = (client_state_t){ .x = rand() % SIDE,
+            .y = rand() % SIDE, .tier = 1 + rand() % (TIER_MAX - 1) };
+        tile_players_add(&WORLD, PLAYERS + i, 1);
+    }
+}
+
+static
+bool scalar_tile_ready(const inventory_t *tile, uint8_t tier)
+{
+    for (size_t i = 0; i < RES_COUNT; i++)
+        if (tile->qnts[i] < INCANTATION_REQUIREMENTS[tier - 1]
+            .resources.qnts[i])
+            return false;
+    return true;
+}
+
+static
+bool scan_ready(uint8_t x, uint8_t y, uint8_t tier)
+{
+    size_t count = 0;
+
+    if (!scalar_tile_ready(&WORLD.map[y][x], tier))
+        return false;
+    for (size_t i = 0; i < PLAYER_COUNT; i++)
+        count += PLAYERS[i].x == x && PLAYERS[i].y == y
+            && PLAYERS[i].tier == tier;
+    return count >= INCANTATION_REQUIREMENTS[tier - 1].player_count;
+}
+
+uint64_t bench_incantation_scalar_tile(uint64_t rounds)
+{
+    uint64_t ready = 0;
+
+    fill_world();
+    for (uint64_t n = 0; n < rounds; n++)
+        ready += scalar_tile_ready(&WORLD.map[n / SIDE % SIDE][n % SIDE],
+            1 + n % (TIER_MAX - 1));
+    return ready;
+}
+
+uint64_t bench_incantation_vector_tile(uint64_t rounds)
+{
+    uint64_t ready = 0;
+
+    fill_world();
+    for (uint64_t n = 0; n < rounds; n++)
+        ready += incantation_tile_ready(
+            &WORLD.map[n / SIDE % SIDE][n % SIDE], 1 + n % (TIER_MAX - 1));
+    return ready;
+}
+
+uint64_t bench_incantation_scan(uint64_t rounds)
+{
+    uint64_t ready = 0;
+
+    fill_world();
+    for (uint64_t n = 0; n < rounds; n++)
+        ready += scan_ready(n % SIDE, n / SIDE % SIDE,
+            1 + n % (TIER_MAX - 1));
+    return ready;
+}
+
+uint64_t bench_incantation_indexed(uint64_t rounds)
+{
+    uint64_t ready = 0;
+
+    fill_world();
+    for (uint64_t n = 0; n < rounds; n++)
+        ready += incantation_ready(&WORLD, n % SIDE, n / SIDE % SIDE,
+            1 + n % (TIER_MAX - 1));
+    return ready;
+}
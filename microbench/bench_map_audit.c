@@ -0,0 +1,79 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "game_events/map_resources.h"
+#include "server.h"
+
+#include "microbench.h"
+
+/** The audit of the resources lying on the map, over 2000 x 2000 tiles, far
+more than a server accepts: a loop over the quantities of each tile against
+the vector sum of map_resources.h. A round adds up a tile, the map being
+swept as many times as the rounds take. **/
+
+static constexpr const size_t AUDIT_SIDE = 2000;
+static constexpr const size_t AUDIT_TILES = AUDIT_SIDE * AUDIT_SIDE;
+
+static inventory_t *AUDIT_MAP;
+
+void bench_map_audit_setup(void)
+{
+    if (AUDIT_MAP != nullptr)
+        return;
+    AUDIT_MAP = calloc(AUDIT_TILES, sizeof *AUDIT_MAP);
+    if (AUDIT_MAP == nullptr) {
+        perror("Can't allocate the map");
+        exit(84);
+    }
+    for (size_t i = 0; i < AUDIT_TILES; i++)
+        for (size_t k = 0; k < RES_COUNT; k++)
+            AUDIT_MAP[i].qnts[k] = (i * 7 + k * 13) % 5;
+}
+
+static
+inventory_t scalar_sum(const inventory_t *tiles, size_t count)
+{
+    inventory_t sum = { };
+
+    for (size_t i = 0; i < count; i++)
+        for (size_t k = 0; k < RES_COUNT; k++)
+            sum.qnts[k] += tiles[i].qnts[k];
+    return sum;
+}
+
+static
+uint64_t fold(const inventory_t *sum)
+{
+    uint64_t folded = 0;
+
+    for (size_t k = 0; k < RES_COUNT; k++)
+        folded = folded * 31 + sum->qnts[k];
+    return folded;
+}
+
+uint64_t bench_map_audit_scalar(uint64_t rounds)
+{
+    uint64_t checksum = 0;
+    inventory_t sum;
+
+    for (uint64_t done = 0; done < rounds; done += AUDIT_TILES) {
+        sum = scalar_sum(AUDIT_MAP, rounds - done < AUDIT_TILES
+            ? rounds - done : AUDIT_TILES);
+        checksum += fold(&sum);
+    }
+    return checksum;
+}
+
+uint64_t bench_map_audit_vector(uint64_t rounds)
+{
+    uint64_t checksum = 0;
+    inventory_t sum;
+
+    for (uint64_t done = 0; done < rounds; done += AUDIT_TILES) {
+        sum = inventory_sum(AUDIT_MAP, rounds - done < AUDIT_TILES
+            ? rounds - done : AUDIT_TILES);
+        checksum += fold(&sum);
+    }
+    return checksum;
+}
@@ -0,0 +1,147 @@
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "client/client.h"
+#include "proto_writer.h"
+#include "server.h"
+
+#include "microbench.h"
+
+/** The replies sent most often, formatted as vappend_to_output does (a
+vsnprintf to size the message, a second one into a buffer on the stack, then
+a copy) against the writers of proto_writer.h filling the output in place.
+The mix cycles through ppo, pin, bct, plv, a broadcast and a level up, with
+numbers of the sizes a game produces. **/
+
+static constexpr const size_t OUTPUT_SIZE = 1 << 20;
+
+static char OUTPUT[OUTPUT_SIZE];
+
+static const char MESSAGE[] = "team blue, gather on 12 7, level 4";
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wformat-nonliteral"
+static
+void fill_and_copy(char *dst, size_t size, const char *fmt, va_list args)
+{
+    char buffer[size + 1];
+
+    vsnprintf(buffer, size + 1, fmt, args);
+    memcpy(dst, buffer, size);
+}
+
+[[gnu::format(printf, 2, 3)]] static
+size_t vformat(char *dst, const char *fmt, ...)
+{
+    va_list args;
+    va_list args_copy;
+    int size;
+
+    va_start(args, fmt);
+    va_copy(args_copy, args);
+    size = vsnprintf(nullptr, 0, fmt, args_copy);
+    va_end(args_copy);
+    fill_and_copy(dst, size, fmt, args);
+    va_end(args);
+    return size;
+}
+#pragma clang diagnostic pop
+
+static
+inventory_t sample_inventory(uint64_t n)
+{
+    inventory_t inv = { };
+
+    for (size_t i = 0; i < RES_COUNT; i++)
+        inv.qnts[i] = (n >> i) % 13;
+    inv.food = 3 + n % 120;
+    return inv;
+}
+
+static
+size_t printf_inventory_reply(char *dst, uint64_t n)
+{
+    inventory_t inv = sample_inventory(n);
+
+    if (n % 6 == 1)
+        return vformat(dst, "pin #%hu %hhu %hhu %s\n", (uint16_t)n,
+            (uint8_t)(n % 42), (uint8_t)(n / 42 % 42),
+            serialize_inventory(&inv));
+    return vformat(dst, "bct %zu %zu %s\n", (size_t)(n % 42),
+        (size_t)(n / 42 % 42), serialize_inventory(&inv));
+}
+
+static
+size_t printf_reply(char *dst, uint64_t n)
+{
+    switch (n % 6) {
+        case 0:
+            return vformat(dst, "ppo #%hu %hhd %hhd %hhu\n", (uint16_t)n,
+                (uint8_t)(n % 42), (uint8_t)(n / 42 % 42),
+                (uint8_t)(n % 4 + 1));
+        case 3:
+            return vformat(dst, "plv #%hu %hhu\n", (uint16_t)n,
+                (uint8_t)(n % 8 + 1));
+        case 4:
+            return vformat(dst, "message %d, %s\n", (int)(n % 9), MESSAGE);
+        case 5:
+            return vformat(dst, "Current level: %d\n", (int)(n % 8 + 1));
+        default:
+            return printf_inventory_reply(dst, n);
+    }
+}
+
+static
+char *writer_reply(char *dst, uint64_t n)
+{
+    inventory_t inv = sample_inventory(n);
+    uint8_t pos[2] = { n % 42, n / 42 % 42 };
+
+    switch (n % 6) {
+        case 0:
+            return proto_ppo(dst, (uint16_t)n, pos, n % 4);
+        case 1:
+            return proto_pin(dst, (uint16_t)n, pos, &inv);
+        case 2:
+            return proto_bct(dst, pos[0], pos[1], &inv);
+        case 3:
+            return proto_plv(dst, (uint16_t)n, n % 8 + 1);
+        case 4:
+            dst = proto_u32(PROTO_LIT(dst, "message "), n % 9);
+            dst = proto_str(PROTO_LIT(dst, ", "), MESSAGE, SSTR_LEN(MESSAGE));
+            return PROTO_LIT(dst, "\n");
+        default:
+            dst = proto_u32(PROTO_LIT(dst, "Current level: "), n % 8 + 1);
+            return PROTO_LIT(dst, "\n");
+    }
+}
+
+uint64_t bench_protocol_printf(uint64_t rounds)
+{
+    uint64_t written = 0;
+    size_t len = 0;
+
+    for (uint64_t n = 0; n < rounds; n++) {
+        if (len > OUTPUT_SIZE - 256)
+            len = 0;
+        len += printf_reply(OUTPUT + len, n);
+        written += OUTPUT[len - 2];
+    }
+    return written;
+}
+
+uint64_t bench_protocol_writer(uint64_t rounds)
+{
+    uint64_t written = 0;
+    char *end = OUTPUT;
+
+    for (uint64_t n = 0; n < rounds; n++) {
+        if (end > OUTPUT + OUTPUT_SIZE - 256)
+            end = OUTPUT;
+        end = writer_reply(end, n);
+        written += end[-2];
+    }
+    return written;
+}
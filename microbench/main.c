@@ -0,0 +1,81 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "utils/common_macros.h"
+
+#include "microbench.h"
+
+static constexpr const uint64_t DEFAULT_ROUNDS = 10000000;
+static constexpr const int EXIT_TEK_FAILURE = 84;
+
+static const microbench_case_t CASES[] = {
+    { "incantation_scalar_tile", bench_incantation_scalar_tile, nullptr },
+    { "incantation_vector_tile", bench_incantation_vector_tile, nullptr },
+    { "incantation_scan", bench_incantation_scan, nullptr },
+    { "incantation_indexed", bench_incantation_indexed, nullptr },
+    { "protocol_printf", bench_protocol_printf, nullptr },
+    { "protocol_writer", bench_protocol_writer, nullptr },
+    { "map_audit_scalar", bench_map_audit_scalar, bench_map_audit_setup },
+    { "map_audit_vector", bench_map_audit_vector, bench_map_audit_setup },
+};
+
+static
+uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Times a case, printing a JSON line like the load generator does.
+ */
+static
+void run_case(const microbench_case_t *bench, uint64_t rounds)
+{
+    uint64_t start;
+    uint64_t checksum;
+    uint64_t elapsed;
+
+    if (bench->setup != nullptr)
+        bench->setup();
+    start = now_ns();
+    checksum = bench->run(rounds);
+    elapsed = now_ns() - start;
+    printf("{\"case\":\"%s\",\"rounds\":%lu,\"ns_per_op\":%.2f,"
+        "\"checksum\":%lu}\n", bench->name, rounds,
+        (double)elapsed / rounds, checksum);
+}
+
+static
+bool is_selected(const char *name, int argc, char *argv[])
+{
+    if (argc <= 2)
+        return true;
+    for (int i = 2; i < argc; i++)
+        if (!strcmp(argv[i], name))
+            return true;
+    return false;
+}
+
+/**
+ * @brief Usage: ./zappy_microbench [rounds [case...]], every case running
+ * when none is named.
+ */
+int main(int argc, char *argv[])
+{
+    uint64_t rounds = argc > 1 ? strtoull(argv[1], nullptr, 10)
+        : DEFAULT_ROUNDS;
+
+    if (rounds == 0)
+        return fprintf(stderr, "Invalid round count\n"), EXIT_TEK_FAILURE;
+    for (size_t i = 0; i < LENGTH_OF(CASES); i++)
+        if (is_selected(CASES[i].name, argc, argv))
+            run_case(CASES + i, rounds);
+    return EXIT_SUCCESS;
+}
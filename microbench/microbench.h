@@ -0,0 +1,28 @@
+#ifndef MICROBENCH_H_
+    #define MICROBENCH_H_
+
+    #include <stdint.h>
+
+/**
+ * @brief A routine timed on its own, away from the network and the loop.
+ */
+typedef struct {
+    const char *name;
+    // Runs the routine rounds times, returning a checksum of the results so
+    // that the compiler keeps the work
+    uint64_t (*run)(uint64_t rounds);
+    // Builds what the case works on, out of the time measured, or nullptr
+    void (*setup)(void);
+} microbench_case_t;
+
+uint64_t bench_incantation_scalar_tile(uint64_t rounds);
+uint64_t bench_incantation_vector_tile(uint64_t rounds);
+uint64_t bench_incantation_scan(uint64_t rounds);
+uint64_t bench_incantation_indexed(uint64_t rounds);
+uint64_t bench_protocol_printf(uint64_t rounds);
+uint64_t bench_protocol_writer(uint64_t rounds);
+void bench_map_audit_setup(void);
+uint64_t bench_map_audit_scalar(uint64_t rounds);
+uint64_t bench_map_audit_vector(uint64_t rounds);
+
+#endif
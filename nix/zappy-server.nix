@@ -2,6 +2,7 @@
   stdenv,
   lib,
   ncurses,
+  zlib,
   debugServer ? false,
 }:
 stdenv.mkDerivation (finalAttrs: let
@@ -16,6 +17,7 @@ in {
   src = ../.;
 
   nativeBuildInputs = [ncurses];
+  buildInputs = [zlib];
 
   makeFlags = [srv-bin-name];
 
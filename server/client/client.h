@@ -4,6 +4,24 @@
     #include "utils/resizable_array.h"
     #include "server.h"
 
+/**
+ * @brief Longest command line accepted from a client, newline excluded.
+ * Longer lines are dropped and answered as an unknown command.
+ */
+static constexpr const size_t CLIENT_MAX_LINE_LEN = 8192;
+
+/**
+ * @brief Capacity past which an emptied client I/O buffer goes back to the
+ * buffer pool instead of being kept by its client.
+ */
+static constexpr const size_t CLIENT_BUFFER_KEEP_MAX = 16384;
+
+/**
+ * @brief Lines of a client processed per intake round. An AI never has more
+ * commands than that in flight, so only floods get spread over rounds.
+ */
+static constexpr const size_t INTAKE_LINE_BUDGET = 10;
+
 /**
  * @brief Structure representing a client state in the server.
  *
@@ -19,9 +37,28 @@ typedef struct client_state_s {
     uint8_t orientation;
     uint32_t id;
     bool is_in_incantation;
+    bool in_overflow;
+    bool intake_paused;
+    bool close_after_flush;
+    bool is_waiting; // Has a command queued, see server_virtual_clock_step
+    uint8_t meal_phase; // Bucket of the food wheel the player eats on
+    uint8_t out_opcode;
+    uint32_t dirty_slot; // Position in cm.dirty plus one, 0 if not listed
     int fd;
+    int stalled_queue; // Bytes its socket held when stalled_since was set
     size_t in_buff_idx;
+    size_t in_scan_idx;
     size_t out_buff_idx;
+    uint64_t stalled_since;
+    uint64_t out_since;
+    uint64_t connected_at;
+    uint64_t intake_lines; // Lines processed, to spot the clients flooding
+    uint64_t intake_round; // Last round it was served in
+    uint32_t intake_budget_hits; // Rounds that ended with lines left over
+    bool intake_backlogged; // Not read from until its lines are processed
+    bool gui_sequenced; // Told the sequence number after each batch
+    bool gui_compressed; // Output is a deflate stream, see out_plain
+    size_t out_plain; // Start of the output not compressed yet
 } client_state_t;
 
 typedef enum {
@@ -37,12 +74,40 @@ enum {
     TEAM_ID_GRAPHIC = 2
 };
 
+static inline
+metrics_class_t client_metrics_class(const client_state_t *client)
+{
+    if (client->team_id <= TEAM_ID_UNASSIGNED)
+        return CLASS_UNASSIGNED;
+    if (client->team_id == TEAM_ID_GRAPHIC)
+        return CLASS_GRAPHIC;
+    return CLASS_PLAYER;
+}
+
 /**
  * @brief Adds a new client to the server.
  *
  * @param srv
  */
 void add_client(server_t *srv);
+/**
+ * @brief Registers a client on an already open file descriptor and greets
+ * it.
+ *
+ * @param srv
+ * @param fd Socket of the client, -1 when replaying a journal.
+ * @return client_state_t* The new client, or nullptr if allocation failed.
+ */
+client_state_t *add_client_state(server_t *srv, int fd);
+/**
+ * @brief Registers a client on an already open file descriptor, without
+ * greeting it: a hosted match adopts clients the lobby greeted.
+ *
+ * @param srv
+ * @param fd Socket of the client.
+ * @return client_state_t* The new client, or nullptr if allocation failed.
+ */
+client_state_t *register_client_state(server_t *srv, int fd);
 /**
  * @brief Removes a client from the server.
  *
@@ -66,6 +131,98 @@ void write_client(server_t *srv, uint32_t idx);
  */
 void read_client(server_t *srv, uint32_t idx);
 
+/**
+ * @brief Frames the next complete line out of the client's input buffer.
+ *
+ * The newline is replaced by a NUL byte; partial lines are left in place
+ * until the rest of them is received.
+ *
+ * @param client
+ * @param len Set to the line length, newline excluded.
+ * @return char* The line, or nullptr if no complete line is buffered.
+ */
+char *client_next_line(client_state_t *client, size_t *len);
+/**
+ * @brief Reclaims the input space taken by already consumed lines.
+ *
+ * @param client
+ */
+void client_input_compact(client_state_t *client);
+
+/**
+ * @brief Runs one command line received from a client: parses it, then
+ * answers it or schedules its event.
+ *
+ * @param srv
+ * @param client
+ * @param line NUL-terminated line, split in place.
+ * @param len
+ */
+void client_process_line(server_t *srv, client_state_t *client,
+    char *line, size_t len);
+
+/**
+ * @brief Pauses or resumes the client's command intake according to how
+ * much of its output is still unsent.
+ *
+ * @param srv
+ * @param client
+ */
+void client_output_watermark(server_t *srv, client_state_t *client);
+/**
+ * @brief Waits for POLLOUT to send the rest of the output of a client the
+ * socket did not take whole.
+ *
+ * @param srv
+ * @param idx
+ */
+void client_output_blocked(server_t *srv, uint32_t idx);
+/**
+ * @brief Resets the output buffer once everything was sent, recording how
+ * long the reply took to leave. Removes the client if it asked to be closed.
+ *
+ * @param srv
+ * @param idx
+ */
+void client_output_flushed(server_t *srv, uint32_t idx);
+
+/**
+ * @brief Makes room at the end of the client's output for a reply written
+ * in place, with the proto_writer.h writers.
+ *
+ * @param srv
+ * @param client
+ * @param max_len Most bytes the reply may take.
+ * @return char* Where to write it, or nullptr if the allocation failed, the
+ * client being removed then.
+ */
+char *reply_reserve(server_t *srv, client_state_t *client, size_t max_len);
+/**
+ * @brief Queues the reply written since reply_reserve, up to end.
+ *
+ * @param srv
+ * @param client
+ * @param end
+ */
+void reply_commit(server_t *srv, client_state_t *client, char *end);
+/**
+ * @brief Appends len bytes to the client's output buffer.
+ *
+ * @param srv
+ * @param client
+ * @param msg
+ * @param len
+ */
+void append_bytes(server_t *srv, client_state_t *client,
+    const char *msg, size_t len);
+/**
+ * @brief Appends len bytes to the output of every GUI.
+ *
+ * @param srv
+ * @param msg
+ * @param len
+ */
+void append_bytes_to_guis(server_t *srv, const char *msg, size_t len);
 /**
  * @brief Appends a message to the client's output buffer.
  *
@@ -89,18 +246,157 @@ void vappend_to_output(
 [[gnu::format(printf, 2, 3)]]
 void send_to_guis(server_t *srv, const char *fmt, ...);
 
+/**
+ * @brief Whether the messages meant for the GUIs have to be formatted: some
+ * are connected, or the stream records them for the ones to come back.
+ */
+static inline
+bool gui_audience(const server_t *srv)
+{
+    return srv->cm.idx_of_gui != srv->cm.idx_of_players
+        || srv->gui_stream.data != nullptr;
+}
+
+/**
+ * @brief Parses the sequence number a GUI joins from, 0 when it has none,
+ * and starts recording the stream if it was not yet.
+ *
+ * @param srv
+ * @param word
+ * @param seq
+ * @return false if the number is invalid or the ring could not be allocated
+ */
+bool gui_stream_open(server_t *srv, const char *word, uint64_t *seq);
+/**
+ * @brief Records a message sent to every GUI.
+ *
+ * @param stream
+ * @param msg
+ * @param len
+ */
+void gui_stream_record(gui_stream_t *stream, const char *msg, size_t len);
+/**
+ * @brief Sends a GUI what was recorded past seq, if the ring still holds it.
+ *
+ * @param srv
+ * @param client
+ * @param seq
+ * @return false if a snapshot has to be sent instead
+ */
+bool gui_stream_resume(server_t *srv, client_state_t *client, uint64_t seq);
+/**
+ * @brief Sends the GUI the current sequence number, then after every batch.
+ *
+ * @param srv
+ * @param client
+ */
+void gui_stream_follow(server_t *srv, client_state_t *client);
+/**
+ * @brief Tells the sequenced GUIs the sequence number, if messages were
+ * recorded since it was last. Called before the output is flushed.
+ *
+ * @param srv
+ */
+void gui_stream_mark(server_t *srv);
+/**
+ * @brief Releases the ring and the compressor of the stream.
+ *
+ * @param stream
+ */
+void gui_stream_close(gui_stream_t *stream);
+
+/**
+ * @brief Sets up the compressor the compressed GUIs share.
+ *
+ * @param srv
+ * @return false if zlib failed to
+ */
+bool gui_deflate_open(server_t *srv);
+/**
+ * @brief Compresses what was queued to a compressed GUI since its last
+ * segment.
+ *
+ * @param srv
+ * @param client
+ */
+void gui_deflate_client(server_t *srv, client_state_t *client);
+/**
+ * @brief Compresses the messages recorded since the last batch, once, then
+ * queues them to every compressed GUI, after what was queued to it alone.
+ *
+ * @param srv
+ */
+void gui_deflate_batch(server_t *srv);
+/**
+ * @brief Releases the compressor.
+ *
+ * @param stream
+ */
+void gui_deflate_close(gui_stream_t *stream);
+
 bool handle_team(server_t *srv, client_state_t *client,
     char *split[static COMMAND_WORD_COUNT]);
 
 static inline
 client_state_t *client_from_id(server_t *srv, uint32_t id)
 {
-    for (size_t i = 0; i < srv->cm.count; i++)
+    for (size_t i = 1; i < srv->cm.count; i++)
         if (srv->cm.clients[i].id == id)
             return &srv->cm.clients[i];
     return nullptr;
 }
 
-char *serialize_inventory(inventory_t *inv);
+/**
+ * @brief Counts a player in (delta 1) or out (delta -1) of the players of its
+ * tile and tier. Called around every change of a player position or tier.
+ */
+static inline
+void tile_players_add(server_t *srv, const client_state_t *cs, int delta)
+{
+    srv->tile_players[cs->y % MAP_MAX_SIDE_SIZE][cs->x % MAP_MAX_SIDE_SIZE]
+        [cs->tier % (TIER_MAX + 1)] += delta;
+}
+
+/**
+ * @brief Counts a player in (delta 1) or out (delta -1) of the players of its
+ * tile and tier, and of its team and tier. Called when a player joins, levels
+ * up or leaves; a move only needs tile_players_add.
+ */
+static inline
+void player_census_add(server_t *srv, const client_state_t *cs, int delta)
+{
+    tile_players_add(srv, cs, delta);
+    srv->team_tiers[cs->team_id][cs->tier % (TIER_MAX + 1)] += delta;
+}
+
+/**
+ * @brief Counts a player in (delta 1) or out (delta -1) of the bucket of
+ * its meal phase.
+ */
+static inline
+void food_wheel_count(server_t *srv, const client_state_t *cs, int delta)
+{
+    srv->food.bucket[cs->meal_phase % FOOD_PERIOD] += delta;
+}
+
+/**
+ * @brief Gives a player arriving in the game its meal phase, and arms the
+ * sweep of that phase if it comes before the armed one.
+ *
+ * @param srv
+ * @param cs
+ * @return false if the sweep could not be queued
+ */
+bool food_wheel_join(server_t *srv, client_state_t *cs);
+/**
+ * @brief Arms the sweep of the first phase after the last tick swept that
+ * has players, if any.
+ *
+ * @param srv
+ * @return false if the sweep could not be queued
+ */
+bool food_wheel_arm_next(server_t *srv);
+
+char *serialize_inventory(const inventory_t *inv);
 
 #endif /* !CLIENT_H_ */
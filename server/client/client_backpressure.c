@@ -0,0 +1,122 @@
+#include <linux/sockios.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+
+#include "utils/buffer_pool.h"
+
+#include "client.h"
+#include "server.h"
+
+/** Whether a paused client still reads is told by the bytes its socket
+holds, rather than by the sends: the kernel buffers megabytes, and a slow
+reader can drain them for seconds before the socket takes any more. **/
+
+static
+int socket_queued(const client_state_t *client)
+{
+    int queued = -1;
+
+    if (client->fd >= 0 && ioctl(client->fd, SIOCOUTQ, &queued) < 0)
+        queued = -1;
+    return queued;
+}
+
+void client_output_watermark(server_t *srv, client_state_t *client)
+{
+    size_t pending = client->output.nmemb - client->out_buff_idx;
+    size_t idx = client - srv->cm.clients;
+
+    if (!client->intake_paused && pending > srv->out_limits.high_water) {
+        DEBUG("Client %d has %zu bytes unsent, pausing its commands",
+            client->fd, pending);
+        client->intake_paused = true;
+        client->stalled_since = get_timestamp();
+        client->stalled_queue = socket_queued(client);
+        srv->cm.server_pfds[idx].events &= ~POLLIN;
+        return;
+    }
+    if (client->intake_paused && pending <= srv->out_limits.low_water) {
+        DEBUG("Client %d drained its output, resuming", client->fd);
+        client->intake_paused = false;
+        client->stalled_since = 0;
+        if (!client->intake_backlogged)
+            srv->cm.server_pfds[idx].events |= POLLIN;
+    }
+}
+
+/**
+ * @brief Restarts the stall timer of a client whose socket queue changed
+ * since the timer started, as it read some of it in the meantime.
+ *
+ * @return false if the client did not read anything
+ */
+static
+bool still_reading(client_state_t *client, uint64_t now)
+{
+    int queued = socket_queued(client);
+
+    if (queued < 0 || queued == client->stalled_queue)
+        return false;
+    client->stalled_queue = queued;
+    client->stalled_since = now;
+    return true;
+}
+
+void disconnect_stalled_clients(server_t *srv)
+{
+    uint64_t now = get_timestamp();
+    client_state_t *client;
+
+    for (size_t i = 1; i < srv->cm.count; i++) {
+        client = srv->cm.clients + i;
+        if (!client->intake_paused
+            || now - client->stalled_since < srv->out_limits.stall_timeout
+            || still_reading(client, now))
+            continue;
+        fprintf(stderr, "Client %u left %zu bytes unread for too long, "
+            "disconnecting\n", client->id,
+            client->output.nmemb - client->out_buff_idx);
+        remove_client(srv, i);
+        i--;
+    }
+}
+
+void client_output_blocked(server_t *srv, uint32_t idx)
+{
+    srv->cm.server_pfds[idx].events |= POLLOUT;
+    client_output_watermark(srv, srv->cm.clients + idx);
+}
+
+void flush_dirty_clients(server_t *srv)
+{
+    client_manager_t *cm = &srv->cm;
+    uint32_t idx;
+
+    gui_stream_mark(srv);
+    while (cm->dirty_count > 0) {
+        idx = cm->dirty[cm->dirty_count - 1];
+        client_manager_clear_dirty(cm, idx);
+        write_client(srv, idx);
+    }
+}
+
+void client_output_flushed(server_t *srv, uint32_t idx)
+{
+    client_state_t *cl = srv->cm.clients + idx;
+
+    if (cl->out_since != 0)
+        metrics_record(srv->metrics, cl->out_opcode, STAGE_FLUSH,
+            get_timestamp() - cl->out_since);
+    cl->out_since = 0;
+    cl->output.nmemb = 0;
+    cl->out_buff_idx = 0;
+    cl->out_plain = 0;
+    srv->cm.server_pfds[idx].events &= ~POLLOUT;
+    client_manager_clear_dirty(&srv->cm, idx);
+    if (cl->output.capacity > CLIENT_BUFFER_KEEP_MAX)
+        buffer_pool_drop(&cl->output);
+    client_output_watermark(srv, cl);
+    if (cl->close_after_flush)
+        remove_client(srv, idx);
+}
@@ -0,0 +1,161 @@
+#define ZLIB_CONST
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <zlib.h>
+
+#include "utils/buffer_pool.h"
+
+#include "client.h"
+#include "server.h"
+
+/** A GUI answering "GRAPHIC <seq> deflate" gets everything past that line as
+a raw deflate stream (RFC 1951, without the zlib header). The messages sent
+to every GUI are compressed once per batch, from the GUI stream, and the
+same bytes are queued to each compressed GUI. What a GUI is sent alone (the
+replies to its commands, its snapshot) is compressed before that on its
+own. Each segment ends with a full flush: it does not refer to the ones
+before, so a shared segment fits after any of them, and a single compressor
+serves every GUI. A client failing to get its segment is shut down, as the
+stream it was sent can no longer be inflated. **/
+
+static constexpr const int DEFLATE_LEVEL = 3;
+
+// What a full flush may add past deflateBound
+static constexpr const size_t DEFLATE_FLUSH_ROOM = 16;
+
+bool gui_deflate_open(server_t *srv)
+{
+    gui_stream_t *stream = &srv->gui_stream;
+
+    if (stream->deflate == nullptr) {
+        stream->deflate = calloc(1, sizeof *stream->deflate);
+        if (stream->deflate == nullptr)
+            return perror("Can't allocate the GUI compressor"), false;
+        if (deflateInit2(stream->deflate, DEFLATE_LEVEL, Z_DEFLATED,
+            -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            free(stream->deflate);
+            stream->deflate = nullptr;
+            return fprintf(stderr, "Can't set up the GUI compressor\n"), false;
+        }
+    }
+    gui_deflate_batch(srv);
+    return true;
+}
+
+static
+bool deflate_begin(gui_stream_t *stream, size_t len)
+{
+    size_t room = deflateBound(stream->deflate, len) + DEFLATE_FLUSH_ROOM;
+
+    stream->deflated.nmemb = 0;
+    if (!sized_struct_ensure_capacity(&stream->deflated, room, 1))
+        return false;
+    stream->deflate->next_out = (Bytef *)stream->deflated.buff;
+    stream->deflate->avail_out = room;
+    return true;
+}
+
+static
+void deflate_feed(gui_stream_t *stream, const char *src, size_t len,
+    int flush)
+{
+    z_stream *z = stream->deflate;
+
+    z->next_in = (const Bytef *)src;
+    z->avail_in = len;
+    deflate(z, flush);
+    stream->deflated.nmemb = (char *)z->next_out - stream->deflated.buff;
+    stream->deflate_in += len;
+}
+
+/**
+ * @brief Queues the last segment compressed to a compressed GUI, or shuts it
+ * down when the segment is missing.
+ */
+static
+void deflate_append(server_t *srv, client_state_t *client, bool ok)
+{
+    const resizable_array_t *seg = &srv->gui_stream.deflated;
+
+    client->output.nmemb = client->out_plain;
+    if (!ok || !buffer_pool_reserve(&client->output, seg->nmemb + 1)) {
+        perror("Can't compress the output of a GUI");
+        shutdown(client->fd, SHUT_RDWR);
+        return;
+    }
+    memcpy(client->output.buff + client->output.nmemb, seg->buff,
+        seg->nmemb);
+    reply_commit(srv, client, client->output.buff + client->output.nmemb
+        + seg->nmemb);
+    client->out_plain = client->output.nmemb;
+}
+
+void gui_deflate_client(server_t *srv, client_state_t *client)
+{
+    gui_stream_t *stream = &srv->gui_stream;
+    size_t len = client->output.nmemb - client->out_plain;
+    uint64_t start = get_timestamp();
+    bool ok;
+
+    if (len == 0)
+        return;
+    ok = deflate_begin(stream, len);
+    if (ok)
+        deflate_feed(stream, client->output.buff + client->out_plain, len,
+            Z_FULL_FLUSH);
+    deflate_append(srv, client, ok);
+    stream->deflate_out += stream->deflated.nmemb;
+    stream->deflate_time += get_timestamp() - start;
+}
+
+static
+bool deflate_shared(gui_stream_t *stream)
+{
+    size_t len = stream->head - stream->deflated_head;
+    size_t at = stream->deflated_head & (GUI_STREAM_SIZE - 1);
+    size_t first = GUI_STREAM_SIZE - at < len ? GUI_STREAM_SIZE - at : len;
+    uint64_t start = get_timestamp();
+
+    if (!deflate_begin(stream, len))
+        return false;
+    deflate_feed(stream, stream->data + at, first, Z_NO_FLUSH);
+    deflate_feed(stream, stream->data, len - first, Z_FULL_FLUSH);
+    stream->deflate_out += stream->deflated.nmemb;
+    stream->deflate_time += get_timestamp() - start;
+    return true;
+}
+
+void gui_deflate_batch(server_t *srv)
+{
+    gui_stream_t *stream = &srv->gui_stream;
+    client_manager_t *cm = &srv->cm;
+    size_t count = 0;
+    bool ok;
+
+    for (size_t i = cm->idx_of_gui; i < cm->idx_of_players
+        && stream->deflated_head != stream->head; i++)
+        if (cm->clients[i].gui_compressed) {
+            gui_deflate_client(srv, cm->clients + i);
+            count++;
+        }
+    if (count != 0) {
+        ok = deflate_shared(stream);
+        for (size_t i = cm->idx_of_gui; i < cm->idx_of_players; i++)
+            if (cm->clients[i].gui_compressed)
+                deflate_append(srv, cm->clients + i, ok);
+    }
+    stream->deflated_head = stream->head;
+}
+
+void gui_deflate_close(gui_stream_t *stream)
+{
+    if (stream->deflate != nullptr)
+        deflateEnd(stream->deflate);
+    free(stream->deflate);
+    stream->deflate = nullptr;
+    free(stream->deflated.buff);
+    stream->deflated = (resizable_array_t){ };
+}
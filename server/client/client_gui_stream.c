@@ -0,0 +1,93 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "client.h"
+#include "server.h"
+
+/** A GUI answering "GRAPHIC <seq>" instead of "GRAPHIC" asks for sequence
+numbers: after each batch of messages sent to every GUI, it gets "seq <n>",
+n being the bytes of such messages sent since the server started. When it
+comes back with the last one it got, and the ring still holds what was sent
+since, it gets these bytes alone. Otherwise, or with a seq of 0, it gets the
+usual snapshot. Either way, "seq <n>" follows, telling where it stands. **/
+
+bool gui_stream_open(server_t *srv, const char *word, uint64_t *seq)
+{
+    char *end;
+
+    errno = 0;
+    *seq = strtoull(word, &end, 10);
+    if (end == word || *end != '\0' || errno != 0 || *word == '-')
+        return false;
+    if (srv->gui_stream.data == nullptr)
+        srv->gui_stream.data = malloc(GUI_STREAM_SIZE);
+    if (srv->gui_stream.data == nullptr)
+        return perror("Can't allocate the GUI stream"), false;
+    return true;
+}
+
+void gui_stream_record(gui_stream_t *stream, const char *msg, size_t len)
+{
+    size_t at;
+    size_t first;
+
+    if (len > GUI_STREAM_SIZE) {
+        msg += len - GUI_STREAM_SIZE;
+        stream->head += len - GUI_STREAM_SIZE;
+        len = GUI_STREAM_SIZE;
+    }
+    at = stream->head & (GUI_STREAM_SIZE - 1);
+    first = GUI_STREAM_SIZE - at < len ? GUI_STREAM_SIZE - at : len;
+    memcpy(stream->data + at, msg, first);
+    memcpy(stream->data, msg + first, len - first);
+    stream->head += len;
+}
+
+bool gui_stream_resume(server_t *srv, client_state_t *client, uint64_t seq)
+{
+    gui_stream_t *stream = &srv->gui_stream;
+    size_t at = seq & (GUI_STREAM_SIZE - 1);
+    size_t missed = stream->head - seq;
+    size_t first = GUI_STREAM_SIZE - at < missed ? GUI_STREAM_SIZE - at
+        : missed;
+
+    if (seq == 0 || seq > stream->head || missed > GUI_STREAM_SIZE) {
+        stream->snapshots++;
+        return false;
+    }
+    if (first != 0)
+        append_bytes(srv, client, stream->data + at, first);
+    if (missed != first)
+        append_bytes(srv, client, stream->data, missed - first);
+    stream->resumes++;
+    return true;
+}
+
+void gui_stream_follow(server_t *srv, client_state_t *client)
+{
+    client->gui_sequenced = true;
+    vappend_to_output(srv, client, "seq %lu\n", srv->gui_stream.head);
+}
+
+void gui_stream_mark(server_t *srv)
+{
+    client_manager_t *cm = &srv->cm;
+
+    gui_deflate_batch(srv);
+    if (srv->gui_stream.marked == srv->gui_stream.head)
+        return;
+    srv->gui_stream.marked = srv->gui_stream.head;
+    for (size_t i = cm->idx_of_gui; i < cm->idx_of_players; i++)
+        if (cm->clients[i].gui_sequenced)
+            vappend_to_output(srv, cm->clients + i, "seq %lu\n",
+                srv->gui_stream.head);
+}
+
+void gui_stream_close(gui_stream_t *stream)
+{
+    gui_deflate_close(stream);
+    free(stream->data);
+    stream->data = nullptr;
+}
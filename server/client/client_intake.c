@@ -0,0 +1,78 @@
+#include <poll.h>
+
+#include "client.h"
+#include "server.h"
+
+/** Intake runs in rounds. Each client gets up to INTAKE_LINE_BUDGET of its
+lines processed per round, the first client served moving along from one
+round to the next, so a bot flooding commands only delays the others by a
+budget. A client left with lines is not read from until they are processed,
+and the next poll does not wait, so the rounds go on until no line is left.
+A client that joins a team moves to its segment, possibly swapping places with
+one not served yet: whoever the round missed is caught by the last check. **/
+
+static
+void intake_update_backlog(server_t *srv, client_state_t *client)
+{
+    size_t idx = client - srv->cm.clients;
+
+    client->intake_backlogged = client->in_scan_idx < client->input.nmemb;
+    if (client->intake_backlogged) {
+        client->intake_budget_hits++;
+        srv->metrics->intake_budget_hits++;
+        srv->intake_backlog = true;
+    }
+    if (client->intake_backlogged || client->intake_paused)
+        srv->cm.server_pfds[idx].events &= ~POLLIN;
+    else
+        srv->cm.server_pfds[idx].events |= POLLIN;
+}
+
+static
+void intake_serve(server_t *srv, client_state_t *client)
+{
+    uint32_t id = client->id;
+    size_t len = 0;
+    char *line;
+
+    client->intake_round = srv->intake_round;
+    for (size_t served = 0; served < INTAKE_LINE_BUDGET; served++) {
+        line = client_next_line(client, &len);
+        if (line == nullptr)
+            break;
+        client->intake_lines++;
+        client_process_line(srv, client, line, len);
+        if (client->id != id)
+            client = client_from_id(srv, id);
+        if (client == nullptr)
+            return;
+    }
+    client_input_compact(client);
+    intake_update_backlog(srv, client);
+}
+
+static
+bool intake_is_due(const server_t *srv, const client_state_t *client)
+{
+    return client->input.buff != nullptr && !client->intake_paused
+        && client->intake_round != srv->intake_round
+        && client->in_scan_idx < client->input.nmemb;
+}
+
+void process_clients_buff(server_t *srv)
+{
+    size_t start = srv->cm.count > 1 ? srv->intake_round % (srv->cm.count - 1)
+        : 0;
+    client_state_t *client;
+
+    srv->intake_round++;
+    srv->intake_backlog = false;
+    for (size_t n = 0; n + 1 < srv->cm.count; n++) {
+        client = srv->cm.clients + 1 + (start + n) % (srv->cm.count - 1);
+        if (intake_is_due(srv, client))
+            intake_serve(srv, client);
+    }
+    for (size_t i = 1; i < srv->cm.count && !srv->intake_backlog; i++)
+        if (intake_is_due(srv, srv->cm.clients + i))
+            srv->intake_backlog = true;
+}
@@ -1,18 +1,20 @@
+#include <errno.h>
 #include <poll.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 
 #include "server.h"
 #include "client.h"
-#include "utils/resizable_array.h"
+#include "utils/buffer_pool.h"
 
-static constexpr const size_t BUFFER_SIZE = 1024;
-static constexpr const size_t ITER_MAX = 4;
+static constexpr const size_t READ_CHUNK_MIN = 1024;
+static constexpr const size_t READ_BUDGET = 262144;
 
 struct network_data_s {
     server_t *srv;
@@ -26,87 +28,98 @@ void error_helper(server_t *srv, const char *msg, uint32_t idx)
     remove_client(srv, idx);
 }
 
+/**
+ * @brief Makes room at the tail of the input buffer for the next recv,
+ * sized from what the kernel already holds for this socket.
+ *
+ * @return size_t Number of bytes recv may write, 0 on allocation failure.
+ * @note A read shorter than the returned size means the socket was drained;
+ * poll being level-triggered, anything arriving later wakes us up again.
+ */
 static
-bool recv_wrapper(server_t *srv, uint32_t idx, char *buffer, ssize_t *res)
+size_t input_reserve(client_state_t *client, size_t budget)
 {
-    client_state_t *client = srv->cm.clients + idx;
-    ssize_t recv_res = recv(client->fd, buffer, BUFFER_SIZE - 1, 0);
+    int pending = 0;
+    size_t want = READ_CHUNK_MIN;
+
+    if (ioctl(client->fd, FIONREAD, &pending) == 0
+        && (size_t)pending > want)
+        want = pending;
+    if (want > budget)
+        want = budget;
+    if (!buffer_pool_reserve(&client->input, want))
+        return 0;
+    if (client->input.capacity - client->input.nmemb < budget)
+        return client->input.capacity - client->input.nmemb;
+    return budget;
+}
 
-    if (recv_res < 0) {
-        DEBUG("fd = %d, idx = %u", client->fd, idx);
-        error_helper(srv, "recv failed", idx);
-        return false;
-    }
+static
+void recv_end(server_t *srv, uint32_t idx, ssize_t recv_res)
+{
     if (recv_res == 0) {
         remove_client(srv, idx);
-        return false;
+        return;
     }
-    *res = recv_res;
-    return true;
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+        return;
+    DEBUG("fd = %d, idx = %u", srv->cm.clients[idx].fd, idx);
+    error_helper(srv, "recv failed", idx);
 }
 
 void read_client(server_t *srv, uint32_t idx)
 {
-    char buffer[BUFFER_SIZE] = {0};
-    ssize_t recv_res = sizeof(buffer) - 1;
     client_state_t *client = srv->cm.clients + idx;
+    ssize_t recv_res = 0;
+    size_t room = 0;
 
-    if (client == nullptr)
-        return;
-    for (size_t i = 0; i < ITER_MAX && recv_res == sizeof(buffer) - 1; i++) {
-        if (!recv_wrapper(srv, idx, buffer, &recv_res))
-            return;
-        if (!sized_struct_ensure_capacity(
-            &client->input, recv_res + 1, sizeof *client->input.buff)) {
+    for (size_t budget = READ_BUDGET; budget > 0 && (size_t)recv_res == room;
+        budget -= recv_res) {
+        room = input_reserve(client, budget);
+        if (room == 0) {
             error_helper(srv, "Input buffer resize failed", idx);
             return;
         }
-        memcpy(client->input.buff + client->input.nmemb, buffer, recv_res);
+        recv_res = recv(client->fd, client->input.buff + client->input.nmemb,
+            room, MSG_DONTWAIT);
+        if (recv_res <= 0) {
+            recv_end(srv, idx, recv_res);
+            return;
+        }
         client->input.nmemb += recv_res;
-        client->input.buff[client->input.nmemb] = '\0';
+        srv->metrics->bytes_in[client_metrics_class(client)] += recv_res;
     }
-    DEBUG("Received from client %d: %s", client->fd, buffer);
 }
 
 void write_client(server_t *srv, uint32_t idx)
 {
     client_state_t *cl = srv->cm.clients + idx;
     ssize_t sent;
-    size_t line_len;
 
-    if (!cl || cl->output.nmemb <= cl->out_buff_idx)
+    if (UNLIKELY(cl->gui_compressed))
+        gui_deflate_client(srv, cl);
+    if (cl->fd < 0 || cl->output.nmemb <= cl->out_buff_idx)
         return;
-    line_len = strcspn(cl->output.buff + cl->out_buff_idx, "\n");
-    if ((cl->output.buff + cl->out_buff_idx)[line_len] != '\n')
-        return;
-    sent = send(cl->fd, cl->output.buff + cl->out_buff_idx, line_len + 1, 0);
-    if (sent < 0) {
-        error_helper(srv, "send failed", idx - 1);
+    sent = send(cl->fd, cl->output.buff + cl->out_buff_idx,
+        cl->output.nmemb - cl->out_buff_idx, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK
+        && errno != EINTR) {
+        error_helper(srv, "send failed", idx);
         return;
     }
-    cl->out_buff_idx += sent;
-    if (cl->out_buff_idx != cl->output.nmemb)
-        return;
-    cl->output.nmemb = 0;
-    cl->out_buff_idx = 0;
-    srv->cm.server_pfds[idx].events &= ~POLLOUT;
+    if (sent > 0) {
+        cl->out_buff_idx += sent;
+        srv->metrics->bytes_out[client_metrics_class(cl)] += sent;
+    }
+    if (cl->out_buff_idx == cl->output.nmemb)
+        client_output_flushed(srv, idx);
+    else
+        client_output_blocked(srv, idx);
 }
 
 void append_to_output(server_t *srv, client_state_t *client, const char *msg)
 {
-    size_t len = strlen(msg);
-    size_t idx = client - srv->cm.clients;
-
-    if (!sized_struct_ensure_capacity(&client->output, len + 1,
-        sizeof *client->output.buff)) {
-        error_helper(srv, "Output buffer resize failed", idx + 1);
-        return;
-    }
-    strncpy(client->output.buff + client->output.nmemb, msg, len + 1);
-    client->output.nmemb += len;
-    if (!strchr(msg, '\n'))
-        return;
-    srv->cm.server_pfds[idx].events |= POLLOUT;
+    append_bytes(srv, client, msg, strlen(msg));
 }
 
 #pragma clang diagnostic push
@@ -122,6 +135,10 @@ static int compute_formatted_size(const char *fmt, va_list args)
     return len;
 }
 
+/**
+ * @brief Formats the message, then appends it to the client, or to every
+ * GUI when data has no client.
+ */
 static void fill_and_append(
     struct network_data_s *data, size_t size, const char *fmt, va_list args)
 {
@@ -129,7 +146,12 @@ static void fill_and_append(
 
     vsnprintf(buffer, size + 1, fmt, args);
     buffer[size] = '\0';
-    append_to_output(data->srv, data->client, buffer);
+    if (data->client != nullptr) {
+        append_bytes(data->srv, data->client, buffer, size);
+        return;
+    }
+    DEBUG("send to guis: [%s]", buffer);
+    append_bytes_to_guis(data->srv, buffer, size);
 }
 
 void vappend_to_output(server_t *srv,
@@ -150,18 +172,18 @@ void vappend_to_output(server_t *srv,
     va_end(args);
 }
 
-// TODO: Improve this function by splitting GUI team into its own v-array
 void send_to_guis(server_t *srv, const char *fmt, ...)
 {
     va_list args;
     int size;
-    static char buff[BUFFER_SIZE] = {};
 
+    if (!gui_audience(srv))
+        return;
     va_start(args, fmt);
     size = compute_formatted_size(fmt, args);
-    vsnprintf(buff, size + 1, fmt, args);
-    DEBUG("send to guis: [%s]", buff);
-    for (size_t i = srv->cm.idx_of_gui; i < srv->cm.idx_of_players; i++)
-        append_to_output(srv, &srv->cm.clients[i], buff);
+    if (size >= 0)
+        fill_and_append(&(struct network_data_s){ srv, nullptr },
+            (size_t)size, fmt, args);
+    va_end(args);
 }
 #pragma clang diagnostic pop
@@ -1,67 +1,126 @@
+#define _GNU_SOURCE
+
 #include <arpa/inet.h>
+#include <errno.h>
 #include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
-#include "utils/resizable_array.h"
+#include "spectator/spectator.h"
+#include "utils/buffer_pool.h"
 
 #include "client.h"
 #include "event.h"
 #include "server.h"
 
-static
-bool add_client_state(server_t *srv, int fd)
+client_state_t *register_client_state(server_t *srv, int fd)
 {
-    static uint32_t id = 0;
     client_state_t *client = client_manager_add(&srv->cm);
     size_t idx;
 
     if (client == nullptr)
-        return false;
+        return nullptr;
     client->fd = fd;
-    client->id = id;
+    client->id = srv->next_client_id;
+    client->connected_at = get_timestamp();
     idx = srv->cm.idx_of_gui - 1;
     srv->cm.server_pfds[idx].fd = fd;
     srv->cm.server_pfds[idx].events = POLLIN;
     srv->cm.server_pfds[idx].revents = 0;
-    id++;
-    append_to_output(srv, client, "WELCOME\n");
-    return true;
+    srv->next_client_id++;
+    journal_event(srv->journal, JOURNAL_CONNECT, client->id, 0);
+    return client;
 }
 
-void add_client(server_t *srv)
+client_state_t *add_client_state(server_t *srv, int fd)
+{
+    client_state_t *client = register_client_state(srv, fd);
+
+    if (client != nullptr)
+        append_to_output(srv, client, "WELCOME\n");
+    return client;
+}
+
+static
+void record_accept(server_t *srv, uint64_t batch)
+{
+    uint64_t wait = get_timestamp() - srv->poll_woke_at;
+    accept_stats_t *stats = &srv->accept_stats;
+
+    stats->accepted++;
+    stats->wait_total += wait;
+    if (wait > stats->wait_max)
+        stats->wait_max = wait;
+    if (batch > stats->batch_max)
+        stats->batch_max = batch;
+}
+
+/**
+ * @brief Accepts one pending connection.
+ *
+ * @return true if the backlog may still hold connections
+ */
+static
+bool accept_one(server_t *srv, int listen_fd, uint64_t batch)
 {
-    struct sockaddr_in addr;
+    struct sockaddr_in addr = { };
     socklen_t addr_len = sizeof(addr);
-    int new_fd = accept(srv->self_fd, (struct sockaddr *)&addr, &addr_len);
+    int new_fd = accept4(listen_fd, (struct sockaddr *)&addr, &addr_len,
+        SOCK_NONBLOCK | SOCK_CLOEXEC);
 
     if (new_fd < 0) {
-        perror("accept failed");
-        return;
+        if (errno == EINTR || errno == ECONNABORTED)
+            return true;
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            perror("accept failed");
+        return false;
     }
-    if (!add_client_state(srv, new_fd)) {
-        close(new_fd);
-        perror("failed to register client");
+    if (add_client_state(srv, new_fd) == nullptr)
+        return close(new_fd), perror("failed to register client"), false;
+    record_accept(srv, batch);
+    DEBUG("New client connected: fd=%d, addr=%s:%d", new_fd,
+        addr.sin_family == AF_INET ? inet_ntoa(addr.sin_addr) : "local",
+        ntohs(addr.sin_port));
+    return true;
+}
+
+void add_client(server_t *srv)
+{
+    uint64_t accepted = srv->accept_stats.accepted;
+
+    while (accept_one(srv, srv->self_fd,
+        srv->accept_stats.accepted - accepted + 1));
+    while (srv->unix_path != nullptr && accept_one(srv, srv->unix_fd,
+        srv->accept_stats.accepted - accepted + 1));
+    if (srv->accept_stats.accepted != accepted)
+        srv->accept_stats.batches++;
+}
+
+static
+void forget_player(server_t *srv, const client_state_t *cs)
+{
+    if (cs->team_id <= TEAM_ID_GRAPHIC)
         return;
-    }
-    DEBUG("New client connected: fd=%d, addr=%s:%d",
-        new_fd, inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
+    player_census_add(srv, cs, -1);
+    food_wheel_count(srv, cs, -1);
+    gui_feed(srv, &(feed_t){ .type = FEED_PLAYER_GONE, .id = cs->id },
+        nullptr);
 }
 
 void remove_client(server_t *srv, uint32_t idx)
 {
     if (idx >= srv->cm.count)
         return;
-    if (srv->cm.clients[idx].team_id > TEAM_ID_GRAPHIC)
-        send_to_guis(srv, "pdi #%hd\n", srv->cm.clients[idx].id);
-    for (size_t i = 0; i < srv->events.nmemb; i++)
-        if (srv->events.buff[i].client_idx == (int)(idx))
-            srv->events.buff[i].client_idx = CLIENT_DEAD;
+    journal_event(srv->journal, JOURNAL_DISCONNECT,
+        srv->cm.clients[idx].id, 0);
+    forget_player(srv, srv->cm.clients + idx);
+    event_queue_forget(&srv->events, srv->cm.clients[idx].id);
     DEBUG("Client disconnected: %u, fd=%d", idx, srv->cm.clients[idx].fd);
     if (srv->cm.clients[idx].fd >= 0)
         close(srv->cm.clients[idx].fd);
-    free(srv->cm.clients[idx].input.buff);
-    free(srv->cm.clients[idx].output.buff);
+    buffer_pool_drop(&srv->cm.clients[idx].input);
+    buffer_pool_drop(&srv->cm.clients[idx].output);
     client_manager_remove(&srv->cm, idx);
 }
@@ -0,0 +1,67 @@
+#include <string.h>
+
+#include "utils/buffer_pool.h"
+
+#include "client.h"
+
+/** Layout of the client input buffer:
+
+`----------`---------------`-----------`------
+| consumed | partial line  | unscanned | free
+`----------`---------------`-----------`------
+           ^ in_buff_idx   ^ in_scan_idx
+                                       ^ nmemb
+
+Bytes before in_scan_idx are known not to hold a newline, so each byte is
+looked at once, no matter how many reads it takes to complete a line. **/
+
+static
+void frame_wait(client_state_t *client)
+{
+    client->in_scan_idx = client->input.nmemb;
+    if (client->input.nmemb - client->in_buff_idx <= CLIENT_MAX_LINE_LEN)
+        return;
+    DEBUG("Client %d line exceeds %zu bytes, dropping it",
+        client->fd, CLIENT_MAX_LINE_LEN);
+    client->input.nmemb = client->in_buff_idx;
+    client->in_scan_idx = client->in_buff_idx;
+    client->in_overflow = true;
+}
+
+char *client_next_line(client_state_t *client, size_t *len)
+{
+    char *start = client->input.buff + client->in_buff_idx;
+    char *nl = nullptr;
+
+    if (client->in_scan_idx < client->input.nmemb)
+        nl = memchr(client->input.buff + client->in_scan_idx, '\n',
+            client->input.nmemb - client->in_scan_idx);
+    if (nl == nullptr)
+        return frame_wait(client), nullptr;
+    *nl = '\0';
+    client->in_buff_idx = (nl - client->input.buff) + 1;
+    client->in_scan_idx = client->in_buff_idx;
+    *len = nl - start;
+    if (!client->in_overflow && *len <= CLIENT_MAX_LINE_LEN)
+        return start;
+    client->in_overflow = false;
+    *start = '\0';
+    *len = 0;
+    return start;
+}
+
+void client_input_compact(client_state_t *client)
+{
+    size_t pending = client->input.nmemb - client->in_buff_idx;
+
+    if (client->in_buff_idx == 0)
+        return;
+    if (pending == 0 && client->input.capacity > CLIENT_BUFFER_KEEP_MAX)
+        buffer_pool_drop(&client->input);
+    if (pending != 0)
+        memmove(client->input.buff,
+            client->input.buff + client->in_buff_idx, pending);
+    client->input.nmemb = pending;
+    client->in_scan_idx -= client->in_buff_idx;
+    client->in_buff_idx = 0;
+}
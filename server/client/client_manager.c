@@ -30,6 +30,10 @@ client_state_t *swap_clients(client_manager_t *cm, size_t i, size_t j)
     tmpfd = cm->server_pfds[i];
     cm->server_pfds[i] = cm->server_pfds[j];
     cm->server_pfds[j] = tmpfd;
+    if (cm->clients[i].dirty_slot != 0)
+        cm->dirty[cm->clients[i].dirty_slot - 1] = i;
+    if (cm->clients[j].dirty_slot != 0)
+        cm->dirty[cm->clients[j].dirty_slot - 1] = j;
     return &cm->clients[i];
 }
 
@@ -41,13 +45,19 @@ bool client_manager_ensure_capacity(client_manager_t *cm, size_t request)
         .nmemb = cm->count,
         .capacity = cm->capacity,
     };
+    resizable_array_t dirty = {
+        .buff = (char *)cm->dirty,
+        .nmemb = cm->count,
+        .capacity = cm->capacity,
+    };
 
     if (!sized_struct_ensure_capacity(&arr, request, sizeof *cm->server_pfds)
-        || !sized_struct_ensure_capacity(
-            (resizable_array_t *)cm, request, sizeof *cm->clients))
+        || !sized_struct_ensure_capacity(&dirty, request, sizeof *cm->dirty))
         return false;
     cm->server_pfds = (struct pollfd *)(void *)arr.buff;
-    return true;
+    cm->dirty = (uint32_t *)(void *)dirty.buff;
+    return sized_struct_ensure_capacity(
+        (resizable_array_t *)cm, request, sizeof *cm->clients);
 }
 
 bool client_manager_init(client_manager_t *cm)
@@ -126,10 +136,34 @@ void client_manager_remove_unassigned(client_manager_t *cm, size_t idx)
     cm->idx_of_players--;
 }
 
+void client_manager_mark_dirty(client_manager_t *cm, size_t idx)
+{
+    if (cm->clients[idx].dirty_slot != 0)
+        return;
+    cm->dirty[cm->dirty_count] = idx;
+    cm->dirty_count++;
+    cm->clients[idx].dirty_slot = cm->dirty_count;
+}
+
+void client_manager_clear_dirty(client_manager_t *cm, size_t idx)
+{
+    uint32_t slot = cm->clients[idx].dirty_slot;
+    uint32_t last;
+
+    if (slot == 0)
+        return;
+    last = cm->dirty[cm->dirty_count - 1];
+    cm->dirty[slot - 1] = last;
+    cm->clients[last].dirty_slot = slot;
+    cm->clients[idx].dirty_slot = 0;
+    cm->dirty_count--;
+}
+
 void client_manager_remove(client_manager_t *cm, size_t idx)
 {
     if (idx >= cm->count)
         return;
+    client_manager_clear_dirty(cm, idx);
     switch (cm->clients[idx].team_id) {
         case SECTION_SERVER:
             break;
@@ -4,6 +4,7 @@
 typedef struct client_state_s client_state_t;
 
     #include <stddef.h>
+    #include <stdint.h>
 
 /** Segment for the client state:
                                            v capacity
@@ -29,6 +30,8 @@ typedef struct {
     size_t idx_of_gui;
     size_t idx_of_players;
     struct pollfd *server_pfds;
+    uint32_t *dirty; // Indices of the clients with output to flush
+    size_t dirty_count;
 } client_manager_t;
 
 bool client_manager_init(client_manager_t *cm);
@@ -49,5 +52,12 @@ void client_manager_remove(client_manager_t *cm, size_t idx);
  **/
 client_state_t *client_manager_promote(client_manager_t *cm, size_t idx);
 
+/** Lists a client as having output to flush, unless it already is. The
+list follows the clients as they get swapped around. **/
+void client_manager_mark_dirty(client_manager_t *cm, size_t idx);
+
+/** Takes a client off the dirty list, if it is on it */
+void client_manager_clear_dirty(client_manager_t *cm, size_t idx);
+
 
 #endif
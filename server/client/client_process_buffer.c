@@ -14,6 +14,7 @@
 #include "game_events/names.h"
 #include "ring_buffer.h"
 #include "server.h"
+#include "spectator/spectator.h"
 
 static constexpr const size_t MAX_GUI_CMD_LEN = 4;
 
@@ -70,46 +71,55 @@ bool is_in_ai_lut(const char *command)
 static
 uint64_t get_late_event(server_t *srv, client_state_t *client, event_t *event)
 {
-    uint64_t late_event = get_timestamp();
+    uint64_t late_event = game_now(srv);
     int idx = client - srv->cm.clients;
     int counter = 0;
 
-    for (size_t i = 0; i < srv->events.nmemb; i++) {
-        if (srv->events.buff[i].client_idx == idx
-            && is_in_ai_lut(srv->events.buff[i].command[0])
-            && srv->events.buff[i].timestamp > late_event) {
-            late_event = srv->events.buff[i].timestamp;
+    for (size_t i = 0; i < srv->events.actions.nmemb; i++) {
+        if (srv->events.actions.buff[i].client_idx == idx
+            && is_in_ai_lut(srv->events.actions.buff[i].command[0])
+            && srv->events.actions.buff[i].timestamp > late_event) {
+            late_event = srv->events.actions.buff[i].timestamp;
             counter++;
         }
     }
-    if (counter >= MAX_CONCURRENT_REQUESTS)
+    if (counter >= MAX_CONCURRENT_REQUESTS) {
         event->command[0] = "ko";
+        event->opcode = METRICS_OPCODE_OTHER;
+    }
     return late_event;
 }
 
+/**
+ * @brief GUI queries skip the queue of the AI actions.
+ */
 static
-void event_create(server_t *srv, client_state_t *client,
-    char *split[static COMMAND_WORD_COUNT], uint64_t time_needed)
+event_lane_t lane_of(const client_state_t *client)
 {
-    uint64_t interval = (time_needed * MICROSEC_IN_SEC) / srv->frequency;
-    event_t event = {
-        .client_idx = client - srv->cm.clients, .client_id = client->id
-    };
+    return client->team_id == TEAM_ID_GRAPHIC ? LANE_GUI : LANE_ACTION;
+}
+
+static
+void event_create(server_t *srv, client_state_t *client, event_t *event,
+    uint64_t time_needed)
+{
+    uint64_t interval = time_needed * GAME_TIME_UNIT;
+    bool is_fork = !strcmp(event->command[0], PLAYER_FORK);
 
-    memcpy(event.command, split, sizeof(event.command));
-    for (event.arg_count = 0; event.arg_count < COMMAND_WORD_COUNT
-        && event.command[event.arg_count] != nullptr; event.arg_count++);
+    for (event->arg_count = 0; event->arg_count < COMMAND_WORD_COUNT
+        && event->command[event->arg_count] != nullptr; event->arg_count++);
     if (client->team_id != TEAM_ID_GRAPHIC)
-        event.timestamp = get_late_event(srv, client, &event) + interval;
+        event->timestamp = get_late_event(srv, client, event) + interval;
     else
-        event.timestamp = get_timestamp();
-    DEBUG("Creating event for client %d: '%s' in %lu ms",
-        client->fd, event.command[0],
-        (event.timestamp - get_timestamp()) / MILISEC_IN_SEC);
-    if (!event_heap_push(&srv->events, &event))
+        event->timestamp = game_now(srv);
+    DEBUG("Creating event for client %d: '%s' in %lu time units",
+        client->fd, event->command[0],
+        (event->timestamp - game_now(srv)) / GAME_TIME_UNIT);
+    if (!event_queue_push(&srv->events, event, lane_of(client)))
         srv->is_running = false;
-    if (!strcmp(split[0], PLAYER_FORK))
-        send_to_guis(srv, "pfk #%hu\n", client->id);
+    if (is_fork)
+        gui_feed(srv, &(feed_t){ .type = FEED_FORK, .id = client->id },
+            nullptr);
 }
 
 static
@@ -120,76 +130,73 @@ void unknown_command(server_t *srv, client_state_t *client,
     event_t event = {
         .client_idx = idx,
         .command = {client->team_id == TEAM_ID_GRAPHIC ? "suc" : "ko"},
-        .client_id = client->id
+        .client_id = client->id, .opcode = METRICS_OPCODE_OTHER
     };
 
     if (client->team_id != TEAM_ID_GRAPHIC)
         event.timestamp = get_late_event(srv, client, &event);
     else
-        event.timestamp = get_timestamp();
+        event.timestamp = game_now(srv);
     DEBUG("Unknown command '%s' from client %d", command, client->fd);
-    if (!event_heap_push(&srv->events, &event)) {
+    if (!event_queue_push(&srv->events, &event, lane_of(client))) {
         srv->is_running = false;
         return;
     }
 }
 
+/**
+ * @brief Schedules the command held by the words of the event.
+ */
 static
-void handle_command(server_t *srv, client_state_t *client,
-    char *split[static COMMAND_WORD_COUNT])
+void handle_command(server_t *srv, client_state_t *client, event_t *event)
 {
     if (client->team_id == TEAM_ID_UNASSIGNED) {
-        if (!handle_team(srv, client, split))
+        if (!handle_team(srv, client, event->command))
             append_to_output(srv, client, "ko\n");
         return;
     }
     for (size_t i = 0; i < AI_LUT_SIZE
         && client->team_id != TEAM_ID_GRAPHIC; i++) {
-        if (strcmp(AI_LUT[i].command, split[0]) == 0) {
-            event_create(srv, client, split, AI_LUT[i].time_needed);
+        if (strcmp(AI_LUT[i].command, event->command[0]) == 0) {
+            event_create(srv, client, event, AI_LUT[i].time_needed);
             return;
         }
     }
     for (size_t i = 0; i < GUI_LUT_SIZE
         && client->team_id == TEAM_ID_GRAPHIC; i++) {
-        if (strcmp(GUI_LUT[i].command, split[0]) == 0) {
-            event_create(srv, client, split, 0);
+        if (strcmp(GUI_LUT[i].command, event->command[0]) == 0) {
+            event_create(srv, client, event, 0);
             return;
         }
     }
-    unknown_command(srv, client, split[0]);
+    unknown_command(srv, client, event->command[0]);
 }
 
+/**
+ * @brief Looks the opcode of the command up, once for both the intake
+ * histogram and the event that carries it to its handler.
+ */
 static
-void process_sub_command(server_t *srv, client_state_t *client)
+void record_intake(server_t *srv, client_state_t *client, event_t *event)
 {
-    size_t command_len = 0;
-    char *split[COMMAND_WORD_COUNT] = {nullptr};
-
-    for (; client->in_buff_idx < client->input.nmemb;) {
-        command_len = strcspn(client->input.buff + client->in_buff_idx, "\n");
-        (client->input.buff + client->in_buff_idx)[command_len] = '\0';
-        command_split(
-            client->input.buff + client->in_buff_idx,
-            split,
-            command_len
-        );
-        client->in_buff_idx += command_len + 1;
-        handle_command(srv, client, split);
-    }
+    event->opcode = METRICS_OPCODE_HANDSHAKE;
+    if (client->team_id != TEAM_ID_UNASSIGNED)
+        event->opcode = metrics_opcode(event->command[0]);
+    metrics_record(srv->metrics, event->opcode, STAGE_INTAKE,
+        get_timestamp() - srv->poll_woke_at);
 }
 
-void process_clients_buff(server_t *srv)
+void client_process_line(server_t *srv, client_state_t *client,
+    char *line, size_t len)
 {
-    client_state_t *client = nullptr;
-
-    for (size_t i = 1; i < srv->cm.count; i++) {
-        client = srv->cm.clients + i;
-        if (client->input.buff == nullptr)
-            continue;
-        if (!(srv->cm.server_pfds[i].revents & POLLIN)
-            || client->in_buff_idx >= client->input.nmemb)
-            continue;
-        process_sub_command(srv, client);
-    }
+    event_t event = {
+        .client_idx = client - srv->cm.clients, .client_id = client->id
+    };
+    bool pinned = journal_pin_clock(srv->journal);
+
+    journal_command(srv->journal, client->id, line, len);
+    command_split(line, event.command, len);
+    record_intake(srv, client, &event);
+    handle_command(srv, client, &event);
+    journal_unpin_clock(pinned);
 }
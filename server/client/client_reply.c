@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "utils/buffer_pool.h"
+
+#include "client.h"
+#include "proto_writer.h"
+#include "server.h"
+
+char *reply_reserve(server_t *srv, client_state_t *client, size_t max_len)
+{
+    if (UNLIKELY(client->gui_compressed)
+        && srv->gui_stream.deflated_head != srv->gui_stream.head)
+        gui_deflate_batch(srv);
+    if (!buffer_pool_reserve(&client->output, max_len + 1)) {
+        perror("Output buffer resize failed");
+        remove_client(srv, client - srv->cm.clients);
+        return nullptr;
+    }
+    return client->output.buff + client->output.nmemb;
+}
+
+void reply_commit(server_t *srv, client_state_t *client, char *end)
+{
+    *end = '\0';
+    if (client->out_since == 0) {
+        client->out_since = get_timestamp();
+        client->out_opcode = srv->metrics->current_opcode;
+    }
+    client->output.nmemb = end - client->output.buff;
+    client_output_watermark(srv, client);
+    client_manager_mark_dirty(&srv->cm, client - srv->cm.clients);
+}
+
+void append_bytes(server_t *srv, client_state_t *client,
+    const char *msg, size_t len)
+{
+    char *dst = reply_reserve(srv, client, len);
+
+    if (dst != nullptr)
+        reply_commit(srv, client, proto_str(dst, msg, len));
+}
+
+void append_bytes_to_guis(server_t *srv, const char *msg, size_t len)
+{
+    client_manager_t *cm = &srv->cm;
+    gui_stream_t *stream = &srv->gui_stream;
+
+    if (stream->data != nullptr && stream->head + len
+        - stream->deflated_head > GUI_STREAM_SIZE)
+        gui_deflate_batch(srv);
+    if (stream->data != nullptr)
+        gui_stream_record(stream, msg, len);
+    for (size_t i = cm->idx_of_gui; i < cm->idx_of_players; i++)
+        if (!cm->clients[i].gui_compressed)
+            append_bytes(srv, cm->clients + i, msg, len);
+}
@@ -32,16 +32,46 @@ bool command_split(char *buff, char *argv[static COMMAND_WORD_COUNT],
  *
  */
 typedef struct {
-    uint64_t timestamp; // Timestamp of the event in milliseconds
+    uint64_t timestamp; // Deadline, in game time (see GAME_TIME_UNIT)
     int client_idx;
     int client_id;
     uint8_t arg_count;
+    uint8_t opcode; // Set by whoever creates it, see metrics_opcode
+    uint32_t seq; // Push order, breaks timestamp ties first-in first-out
     union {
         char *command[COMMAND_WORD_COUNT]; // Command words for the event
         char *action[COMMAND_WORD_COUNT]; // Action words for the event
     };
 } event_t;
 
+/**
+ * Events due at the same time fire in the order they were pushed, whatever
+ * the shape of the heap: replaying a journal relies on it.
+ **/
+static inline
+bool event_before(const event_t *a, const event_t *b)
+{
+    if (a->timestamp != b->timestamp)
+        return a->timestamp < b->timestamp;
+    return (int32_t)(a->seq - b->seq) < 0;
+}
+
+/**
+ * @brief Copies an event into a queue slot, duplicating its words.
+ *
+ * @param dst
+ * @param src
+ * @param seq Push order of the copy
+ * @return false if a word could not be duplicated
+ */
+bool event_copy(event_t *dst, const event_t *src, uint32_t seq);
+/**
+ * @brief Frees the words of a queued event.
+ *
+ * @param event
+ */
+void event_words_free(event_t *event);
+
 /**
  * @brief Structure representing a heap of events.
  *
@@ -50,6 +80,7 @@ typedef struct {
     event_t *buff; // Pointer to the array of events
     size_t nmemb; // Number of events currently in the heap
     size_t capacity; // Maximum number of events the heap can hold
+    uint32_t next_seq; // Sequence number of the next pushed event
 } event_heap_t;
 
 /**
@@ -75,6 +106,18 @@ void event_heap_free(event_heap_t *heap);
  * @return false
  */
 bool event_heap_push(event_heap_t *heap, const event_t *event);
+/**
+ * @brief Pushes an event with a push order given by the caller, for heaps
+ * sharing a sequence.
+ *
+ * @param heap
+ * @param event
+ * @param seq
+ * @return true
+ * @return false
+ */
+bool event_heap_insert(event_heap_t *heap, const event_t *event,
+    uint32_t seq);
 /**
  * @brief Pops the top event from the event heap.
  *
@@ -112,6 +155,83 @@ const event_t *event_heap_peek(const event_heap_t *heap)
     return &heap->buff[0];
 }
 
+/**
+ * @brief Lanes of the event queue, each one with its own structure.
+ */
+typedef enum {
+    LANE_GUI, // GUI queries, answered as soon as they are read
+    LANE_ACTION, // AI commands, due once their time units have elapsed
+    LANE_TIMER, // Server timers: meteors and starvation
+    LANE_COUNT
+} event_lane_t;
+
+/**
+ * @brief First-in first-out queue of events, for the GUI lane whose events
+ * are all due at once.
+ */
+typedef struct {
+    event_t *buff;
+    size_t nmemb;
+    size_t capacity;
+    size_t head; // Index of the oldest event
+} event_fifo_t;
+
+/**
+ * @brief The events of the server, in lanes: the GUI queries are answered
+ * before anything else, then the timers and the actions fire in deadline
+ * order, so that neither of them delays the other.
+ */
+typedef struct {
+    event_fifo_t gui;
+    event_heap_t actions;
+    event_heap_t timers;
+    uint32_t next_seq; // Shared by the lanes, so that ties keep push order
+} event_queue_t;
+
+bool event_queue_init(event_queue_t *queue);
+void event_queue_free(event_queue_t *queue);
+/**
+ * @brief Pushes a copy of an event, with its words, in a lane.
+ *
+ * @param queue
+ * @param event
+ * @param lane
+ * @return false if it could not be allocated
+ */
+bool event_queue_push(event_queue_t *queue, const event_t *event,
+    event_lane_t lane);
+/**
+ * @brief Peeks at the event to fire next: the oldest GUI query if any, the
+ * earliest of the timers and the actions otherwise.
+ *
+ * @param queue
+ * @param lane Set to the lane of the event
+ * @return const event_t* nullptr if the queue is empty
+ */
+const event_t *event_queue_peek(const event_queue_t *queue,
+    event_lane_t *lane);
+/**
+ * @brief Removes the event event_queue_peek returned.
+ *
+ * @param queue
+ * @param lane
+ */
+void event_queue_pop(event_queue_t *queue, event_lane_t lane);
+/**
+ * @brief Marks the events of a client as dead, in every lane.
+ *
+ * @param queue
+ * @param client_id
+ */
+void event_queue_forget(event_queue_t *queue, uint32_t client_id);
+
+static inline
+size_t event_queue_depth(const event_queue_t *queue)
+{
+    return queue->gui.nmemb - queue->gui.head + queue->actions.nmemb
+        + queue->timers.nmemb;
+}
+
 typedef struct client_state_s client_state_t;
 typedef struct server_s server_t;
 
@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/debug.h"
+#include "utils/resizable_array.h"
+
+#include "event.h"
+
+/** GUI queries do not depend on game time: they are queued in arrival order
+and answered before any other event, so that no backlog of AI actions delays
+them. They only come from what the last poll round read, which bounds the
+time they take from the game. The timers and the actions are kept apart so
+that each heap stays small, and fire in deadline order, ties broken by the
+sequence the lanes share. The policy depends on nothing but the queue, so a
+replayed journal fires the same events in the same order. **/
+
+bool event_copy(event_t *dst, const event_t *src, uint32_t seq)
+{
+    size_t i = 0;
+
+    *dst = *src;
+    dst->seq = seq;
+    for (; src->command[i] != nullptr; i++) {
+        dst->command[i] = strdup(src->command[i]);
+        if (dst->command[i] == nullptr) {
+            DEBUG_MSG("Failed to allocate memory for command string");
+            return false;
+        }
+    }
+    dst->command[i] = nullptr;
+    dst->arg_count = i;
+    return true;
+}
+
+void event_words_free(event_t *event)
+{
+    for (size_t i = 0; event->command[i] != nullptr; i++) {
+        free(event->command[i]);
+        event->command[i] = nullptr;
+    }
+}
+
+static
+bool fifo_push(event_fifo_t *fifo, const event_t *event, uint32_t seq)
+{
+    if (fifo->head > 0 && fifo->head * 2 >= fifo->nmemb) {
+        memmove(fifo->buff, fifo->buff + fifo->head,
+            (fifo->nmemb - fifo->head) * sizeof *fifo->buff);
+        fifo->nmemb -= fifo->head;
+        fifo->head = 0;
+    }
+    if (!sized_struct_ensure_capacity((resizable_array_t *)fifo, 1,
+        sizeof *fifo->buff)
+        || !event_copy(fifo->buff + fifo->nmemb, event, seq))
+        return false;
+    fifo->nmemb++;
+    return true;
+}
+
+bool event_queue_init(event_queue_t *queue)
+{
+    *queue = (event_queue_t){ };
+    return event_heap_init(&queue->actions)
+        && event_heap_init(&queue->timers);
+}
+
+void event_queue_free(event_queue_t *queue)
+{
+    for (size_t i = queue->gui.head; i < queue->gui.nmemb; i++)
+        event_words_free(queue->gui.buff + i);
+    free(queue->gui.buff);
+    queue->gui = (event_fifo_t){ };
+    event_heap_free(&queue->actions);
+    event_heap_free(&queue->timers);
+}
+
+bool event_queue_push(event_queue_t *queue, const event_t *event,
+    event_lane_t lane)
+{
+    uint32_t seq = queue->next_seq++;
+
+    if (lane == LANE_GUI)
+        return fifo_push(&queue->gui, event, seq);
+    return event_heap_insert(lane == LANE_TIMER ? &queue->timers
+        : &queue->actions, event, seq);
+}
+
+const event_t *event_queue_peek(const event_queue_t *queue,
+    event_lane_t *lane)
+{
+    const event_t *action = event_heap_peek(&queue->actions);
+    const event_t *timer = event_heap_peek(&queue->timers);
+
+    if (queue->gui.head < queue->gui.nmemb) {
+        *lane = LANE_GUI;
+        return queue->gui.buff + queue->gui.head;
+    }
+    if (timer != nullptr && (action == nullptr
+        || event_before(timer, action))) {
+        *lane = LANE_TIMER;
+        return timer;
+    }
+    *lane = LANE_ACTION;
+    return action;
+}
+
+void event_queue_pop(event_queue_t *queue, event_lane_t lane)
+{
+    if (lane == LANE_TIMER) {
+        event_heap_pop(&queue->timers);
+        return;
+    }
+    if (lane == LANE_ACTION) {
+        event_heap_pop(&queue->actions);
+        return;
+    }
+    if (queue->gui.head == queue->gui.nmemb)
+        return;
+    event_words_free(queue->gui.buff + queue->gui.head);
+    queue->gui.head++;
+    if (queue->gui.head == queue->gui.nmemb) {
+        queue->gui.head = 0;
+        queue->gui.nmemb = 0;
+    }
+}
+
+static
+void mark_dead(event_t *events, size_t count, uint32_t client_id)
+{
+    for (size_t i = 0; i < count; i++)
+        if (events[i].client_idx > 0
+            && (uint32_t)events[i].client_id == client_id)
+            events[i].client_idx = CLIENT_DEAD;
+}
+
+void event_queue_forget(event_queue_t *queue, uint32_t client_id)
+{
+    mark_dead(queue->gui.buff + queue->gui.head,
+        queue->gui.nmemb - queue->gui.head, client_id);
+    mark_dead(queue->actions.buff, queue->actions.nmemb, client_id);
+    mark_dead(queue->timers.buff, queue->timers.nmemb, client_id);
+}
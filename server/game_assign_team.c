@@ -2,24 +2,22 @@
 #include <string.h>
 
 #include "client/client.h"
-#include "game_events/names.h"
+#include "game_events/handler.h"
+#include "spectator/spectator.h"
 #include "server.h"
 
 static constexpr const uint64_t INITIAL_FOOD_INVENTORY = 10;
 static constexpr const uint8_t FOUR_MASK = 0b11;
 static const char *GRAPHIC_COMMAND = "GRAPHIC";
+static const char *DEFLATE_OPTION = "deflate";
 
 static
 void send_guis_player_data(server_t *srv, client_state_t *client, size_t egg)
 {
-    for (size_t i = srv->cm.idx_of_gui; i < srv->cm.idx_of_players; i++) {
-        vappend_to_output(srv, &srv->cm.clients[i],
-            "pnw #%d %hhu %hhu %hhu %hhu %s\npin #%d %hhu %hhu %s\nebo #%zu\n",
-            client->id, client->x, client->y, client->orientation + 1,
-            client->tier, srv->team_names[client->team_id],
-            client->id, client->x, client->y,
-            serialize_inventory(&client->inv), egg + 1);
-    }
+    feed_t feed = feed_of_player(FEED_PLAYER_JOIN, client);
+
+    feed.index = egg;
+    gui_feed(srv, &feed, nullptr);
 }
 
 static
@@ -29,6 +27,7 @@ bool assign_ai_egg_data(server_t *srv, client_state_t *client, size_t team_id)
         if (srv->eggs.buff[i].team_id == team_id) {
             client->x = srv->eggs.buff[i].x;
             client->y = srv->eggs.buff[i].y;
+            player_census_add(srv, client, 1);
             srv->eggs.buff[i] = srv->eggs.buff[srv->eggs.nmemb - 1];
             srv->eggs.nmemb--;
             send_guis_player_data(srv, client, i);
@@ -40,20 +39,11 @@ bool assign_ai_egg_data(server_t *srv, client_state_t *client, size_t team_id)
 static
 bool assign_ai_data(server_t *srv, client_state_t *client, size_t team_id)
 {
-    event_t event = {
-        .timestamp = get_timestamp(),
-        .client_idx = client - srv->cm.clients,
-        .client_id = client->id,
-        .command = {PLAYER_DEATH}
-    };
-
-    DEBUG("Player (id: %u) death incoming in %lu ms",
-        client->id, (event.timestamp - get_timestamp()) / MILISEC_IN_SEC);
     client->team_id = team_id;
     client->orientation = (rand() & FOUR_MASK);
     client->inv.food = INITIAL_FOOD_INVENTORY;
     client->tier = 1;
-    if (!event_heap_push(&srv->events, &event)) {
+    if (!food_wheel_join(srv, client)) {
         srv->is_running = false;
         return false;
     }
@@ -74,7 +64,7 @@ bool send_ai_team_assignment_respone(
     DEBUG("Client %d assigned to the team with id %zu", client->fd, team_id);
     for (size_t i = 0; i < srv->eggs.nmemb; i++)
         count += srv->eggs.buff[i].team_id == team_id
-            && srv->eggs.buff[i].hatch <= get_timestamp();
+            && srv->eggs.buff[i].hatch <= game_now(srv);
     if (count == 0)
         return vappend_to_output(srv, client, "ko\n"), false;
     vappend_to_output(srv, client, "%u\n%hhu %hhu\n",
@@ -99,25 +89,64 @@ void send_players_info(server_t *srv, client_state_t *client)
 }
 
 static
-bool send_gui_team_assignment_respone(server_t *srv, client_state_t *client)
+void send_gui_snapshot(server_t *srv, client_state_t *client)
 {
-    client->team_id = TEAM_ID_GRAPHIC;
-    client = client_manager_promote(&srv->cm, client - srv->cm.clients);
-    if (client == nullptr)
-        return false;
-    DEBUG("Client %d assigned to GRAPHIC team", client->fd);
     vappend_to_output(srv, client, "msz %hhu %hhu\nsgt %hu\n",
         srv->map_width, srv->map_height, srv->frequency);
-    for (size_t y = 0; y < srv->map_height; y++)
-        for (size_t x = 0; x < srv->map_width; x++)
-            vappend_to_output(srv, client, "bct %zu %zu %s\n",
-                x, y, serialize_inventory(&srv->map[y][x]));
+    if (!gui_send_map_content(srv, client))
+        return;
     for (size_t i = 0; srv->team_names[i] != nullptr; i++)
         vappend_to_output(srv, client, "tna %s\n", srv->team_names[i]);
     send_players_info(srv, client);
     for (size_t i = 0; i < srv->eggs.nmemb; i++)
         vappend_to_output(srv, client, "enw #%zu #-1 %hhu %hhu\n", i,
             srv->eggs.buff[i].x, srv->eggs.buff[i].y);
+}
+
+/**
+ * @brief Checks what a GUI may follow GRAPHIC with, a sequence number then
+ * "deflate", and sets up what they need.
+ */
+static
+bool open_gui_options(server_t *srv, char *split[static COMMAND_WORD_COUNT],
+    uint64_t *seq)
+{
+    if (split[1] == nullptr)
+        return true;
+    if (!gui_stream_open(srv, split[1], seq))
+        return false;
+    if (split[2] == nullptr)
+        return true;
+    return split[3] == nullptr && !strcmp(split[2], DEFLATE_OPTION)
+        && gui_deflate_open(srv);
+}
+
+/**
+ * A GUI giving a sequence number gets what it missed since, when the stream
+ * still holds it, instead of the snapshot. Asking for compression, it gets
+ * everything past its GRAPHIC line compressed.
+ */
+static
+bool send_gui_team_assignment_respone(server_t *srv, client_state_t *client,
+    char *split[static COMMAND_WORD_COUNT])
+{
+    uint64_t seq = 0;
+    uint32_t id = client->id;
+
+    if (!open_gui_options(srv, split, &seq))
+        return false;
+    client->team_id = TEAM_ID_GRAPHIC;
+    client = client_manager_promote(&srv->cm, client - srv->cm.clients);
+    if (client == nullptr)
+        return false;
+    DEBUG("Client %d assigned to GRAPHIC team", client->fd);
+    client->gui_compressed = split[2] != nullptr;
+    client->out_plain = client->output.nmemb;
+    if (split[1] == nullptr || !gui_stream_resume(srv, client, seq))
+        send_gui_snapshot(srv, client);
+    client = client_from_id(srv, id);
+    if (split[1] != nullptr && client != nullptr)
+        gui_stream_follow(srv, client);
     return true;
 }
 
@@ -127,7 +156,15 @@ bool handle_team(server_t *srv, client_state_t *client,
     if (client->team_id != TEAM_ID_UNASSIGNED)
         return false;
     if (!strcmp(split[0], GRAPHIC_COMMAND))
-        return send_gui_team_assignment_respone(srv, client);
+        return srv->spectator == nullptr
+            && send_gui_team_assignment_respone(srv, client, split);
+    if (!strcmp(split[0], METRICS_HANDSHAKE)) {
+        metrics_export(srv, client);
+        client->close_after_flush = true;
+        return true;
+    }
+    if (srv->is_observer)
+        return false;
     for (size_t i = 0; srv->team_names[i] != nullptr; i++)
         if (!strcmp(srv->team_names[i], split[0]))
             return send_ai_team_assignment_respone(srv, client, i);
@@ -1,15 +1,18 @@
-#include <stdio.h>
-
 #include "client/client.h"
-#include "utils/common_macros.h"
+#include "proto_writer.h"
 #include "server.h"
 
-char *serialize_inventory(inventory_t *inv)
+const char PROTO_DIGIT_PAIRS[200] =
+    "00010203040506070809" "10111213141516171819"
+    "20212223242526272829" "30313233343536373839"
+    "40414243444546474849" "50515253545556575859"
+    "60616263646566676869" "70717273747576777879"
+    "80818283848586878889" "90919293949596979899";
+
+char *serialize_inventory(const inventory_t *inv)
 {
-    static char buffer[RES_COUNT * (SSTR_LEN(XCAT(INT_MAX)) + 1)];
+    static thread_local char buffer[PROTO_INVENTORY_MAX_LEN + 1];
 
-    snprintf(buffer, sizeof(buffer), "%u %u %u %u %u %u %u",
-        inv->food, inv->linemate, inv->deraumere, inv->sibur,
-        inv->mendiane, inv->phiras, inv->thystame);
+    *proto_inventory(buffer, inv) = '\0';
     return buffer;
 }
@@ -71,26 +71,62 @@ void default_handler(server_t *srv, const event_t *event)
         append_to_output(srv, client, "ko\n");
 }
 
-void server_handle_events(server_t *srv)
+static
+void run_event(server_t *srv, const event_t *e, uint64_t now)
 {
-    bool (*handler)(server_t *, const event_t *);
+    bool (*handler)(server_t *, const event_t *) = find_handler(e->command[0]);
+    bool pinned = journal_pin_clock(srv->journal);
 
-    for (const event_t *e = event_heap_peek(&srv->events)
-        ; e != nullptr && e->timestamp <= get_timestamp()
-        ; event_heap_pop(&srv->events)) {
-        e = event_heap_peek(&srv->events);
-        DEBUG("event [%s] for client %d", e->command[0], e->client_id);
-        if (e->client_idx == CLIENT_DEAD)
-            continue;
-        handler = find_handler(e->command[0]);
-        if (handler == nullptr) {
-            default_handler(srv, e);
-            continue;
-        }
-        if (!handler(srv, e)) {
-            DEBUG("Event handler failed for command [%s] from client %d",
-                e->command[0], e->client_id);
-        }
-        e = event_heap_peek(&srv->events);
+    metrics_record(srv->metrics, e->opcode, STAGE_FIRE,
+        now - wall_time_of(srv, e->timestamp));
+    journal_event(srv->journal, JOURNAL_FIRE, e->client_id, e->opcode);
+    srv->metrics->current_opcode = e->opcode;
+    if (handler == nullptr) {
+        default_handler(srv, e);
+    } else if (!handler(srv, e)) {
+        DEBUG("Event handler failed for command [%s] from client %d",
+            e->command[0], e->client_id);
     }
+    srv->metrics->current_opcode = METRICS_OPCODE_HANDSHAKE;
+    journal_unpin_clock(pinned);
+}
+
+const event_t *server_next_due_event(server_t *srv, uint64_t now)
+{
+    event_lane_t lane;
+    const event_t *e = event_queue_peek(&srv->events, &lane);
+    uint64_t game_time = game_time_at(srv, now);
+
+    while (e != nullptr && e->timestamp <= game_time
+        && e->client_idx == CLIENT_DEAD) {
+        event_queue_pop(&srv->events, lane);
+        e = event_queue_peek(&srv->events, &lane);
+    }
+    if (e == nullptr || e->timestamp > game_time)
+        return nullptr;
+    return e;
+}
+
+bool server_fire_next_event(server_t *srv, uint64_t now)
+{
+    const event_t *e = server_next_due_event(srv, now);
+    event_lane_t lane;
+
+    if (e == nullptr)
+        return false;
+    DEBUG("event [%s] for client %d", e->command[0], e->client_id);
+    run_event(srv, e, now);
+    event_queue_peek(&srv->events, &lane);
+    event_queue_pop(&srv->events, lane);
+    return true;
+}
+
+void server_handle_events(server_t *srv)
+{
+    size_t depth = event_queue_depth(&srv->events);
+
+    if (depth > srv->metrics->event_queue_max)
+        srv->metrics->event_queue_max = depth;
+    while (server_fire_next_event(srv, get_timestamp()));
+    flush_dirty_clients(srv);
 }
@@ -0,0 +1,38 @@
+#include <stdio.h>
+
+#include "map_resources.h"
+#include "server.h"
+
+const char *const RESOURCE_NAMES[RES_COUNT] = {
+    "food", "linemate", "deraumere", "sibur", "mendiane", "phiras", "thystame"
+};
+
+inventory_t map_resources_count(const server_t *srv)
+{
+    inventory_t total = { };
+    inventory_t row;
+
+    for (size_t y = 0; y < srv->map_height; y++) {
+        row = inventory_sum(srv->map[y], srv->map_width);
+        for (size_t i = 0; i < RES_COUNT; i++)
+            total.qnts[i] += row.qnts[i];
+    }
+    return total;
+}
+
+bool map_resources_audit(const server_t *srv, FILE *stream)
+{
+    inventory_t found = map_resources_count(srv);
+    bool ok = true;
+
+    fprintf(stream, "map resources:");
+    for (size_t i = 0; i < RES_COUNT; i++) {
+        fprintf(stream, " %s=%u", RESOURCE_NAMES[i], found.qnts[i]);
+        if (found.qnts[i] != srv->total_item_in_map.qnts[i])
+            fprintf(stream, " (counted %u)",
+                srv->total_item_in_map.qnts[i]);
+        ok &= found.qnts[i] == srv->total_item_in_map.qnts[i];
+    }
+    fprintf(stream, ok ? ", count ok\n" : ", count DRIFTED\n");
+    return ok;
+}
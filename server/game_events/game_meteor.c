@@ -3,8 +3,11 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+#include "spectator/spectator.h"
+
 #include "names.h"
 #include "handler.h"
+#include "map_resources.h"
 
 static constexpr const float DENSITIES[RES_COUNT] = {
     0.5F, 0.3F, 0.15F, 0.1F, 0.1F, 0.08F, 0.05F,
@@ -15,7 +18,7 @@ static const char *RES_NAMES[RES_COUNT] = {
     "food", "linemate", "deraumere", "sibur", "mendiane", "phiras", "thystame"
 };
 
-static constexpr const double METEOR_PERIODICITY_SEC = 20.0F;
+static constexpr const uint64_t METEOR_PERIODICITY = 20;
 
 [[gnu::unused]] static
 void log_map(server_t *srv)
@@ -44,17 +47,16 @@ void log_map(server_t *srv)
 
 static bool meteor_rescedule(server_t *srv, const event_t *event)
 {
-    uint64_t interval_sec =
-        (METEOR_PERIODICITY_SEC * MICROSEC_IN_SEC) / srv->frequency;
+    uint64_t interval = METEOR_PERIODICITY * GAME_TIME_UNIT;
     event_t new = {
         .client_idx = event->client_idx,
-        .command = { METEOR },
-        .timestamp = event->timestamp + interval_sec,
+        .command = { METEOR }, .opcode = event->opcode,
+        .timestamp = event->timestamp + interval,
     };
 
-    DEBUG("Meteor incoming in %ld ms",
-        (new.timestamp - get_timestamp()) / MILISEC_IN_SEC);
-    if (!event_heap_push(&srv->events, &new)) {
+    DEBUG("Meteor incoming in %lu time units",
+        (new.timestamp - game_now(srv)) / GAME_TIME_UNIT);
+    if (!event_queue_push(&srv->events, &new, LANE_TIMER)) {
         perror("Failed to reschedule meteor event");
         return false;
     }
@@ -75,9 +77,11 @@ bool game_meteor_handler(server_t *srv, const event_t *event)
         for (ssize_t i = 0; i < qty_needed; i++) {
             x = rand() % srv->map_width;
             y = rand() % srv->map_height;
-            srv->map[y][x].qnts[n]++;
-            srv->total_item_in_map.qnts[n]++;
+            map_resource_add(srv, &srv->map[y][x], n, 1);
+            gui_feed(srv, &(feed_t){ .type = FEED_TILE, .x = x, .y = y,
+                .tile = srv->map[y][x] }, nullptr);
         }
     }
+    DEBUG_CALL(map_resources_audit, srv, stdout);
     return meteor_rescedule(srv, event);
 }
@@ -1,6 +1,7 @@
 #include "client/client.h"
 #include "handler.h"
 #include "names.h"
+#include "proto_writer.h"
 
 bool gui_map_size_handler(server_t *srv, const event_t *event)
 {
@@ -15,6 +16,17 @@ bool gui_map_size_handler(server_t *srv, const event_t *event)
     return true;
 }
 
+bool gui_send_map_content(server_t *srv, client_state_t *cs)
+{
+    char *dst = reply_reserve(srv, cs,
+        srv->map_width * srv->map_height * PROTO_TILE_MSG_MAX_LEN);
+
+    if (dst == nullptr)
+        return false;
+    reply_commit(srv, cs, proto_map_content(dst, srv));
+    return true;
+}
+
 bool gui_map_content_handler(server_t *srv, const event_t *event)
 {
     client_state_t *cs = event_get_client(srv, event);
@@ -23,13 +35,19 @@ bool gui_map_content_handler(server_t *srv, const event_t *event)
         return cs;
     if (event->arg_count != 1)
         return append_to_output(srv, cs, "sbp\n"), true;
-    for (size_t y = 0; y < srv->map_height; y++)
-        for (size_t x = 0; x < srv->map_width; x++)
-            vappend_to_output(srv, cs, "bct %zu %zu %s\n",
-                x, y, serialize_inventory(&srv->map[y][x]));
+    gui_send_map_content(srv, cs);
     return true;
 }
 
+static
+void send_tile_content(server_t *srv, client_state_t *cs, size_t x, size_t y)
+{
+    char *dst = reply_reserve(srv, cs, PROTO_TILE_MSG_MAX_LEN);
+
+    if (dst != nullptr)
+        reply_commit(srv, cs, proto_bct(dst, x, y, &srv->map[y][x]));
+}
+
 bool gui_tile_content_handler(server_t *srv, const event_t *event)
 {
     client_state_t *cs = event_get_client(srv, event);
@@ -49,8 +67,7 @@ bool gui_tile_content_handler(server_t *srv, const event_t *event)
     if (endptr1 == arg1 || *endptr1 != '\0' || endptr2 == arg2 ||
         *endptr2 != '\0' || x >= srv->map_width || y >= srv->map_height)
         return append_to_output(srv, cs, "sbp\n"), true;
-    vappend_to_output(srv, cs, "bct %zu %zu %s\n",
-        x, y, serialize_inventory(&srv->map[y][x]));
+    send_tile_content(srv, cs, x, y);
     return true;
 }
 
@@ -1,6 +1,8 @@
 #include "client/client.h"
+#include "spectator/spectator.h"
 #include "handler.h"
 #include "names.h"
+#include "proto_writer.h"
 
 static
 client_state_t *gui_handler_get_player(server_t *srv, const event_t *event)
@@ -24,19 +26,21 @@ bool gui_player_get_position_handler(server_t *srv, const event_t *event)
 {
     client_state_t *cs = event_get_client(srv, event);
     client_state_t *player;
+    char *dst;
 
     if (cs == nullptr)
         return false;
     if (cs->team_id != TEAM_ID_GRAPHIC)
-        return send_to_guis(srv, GUI_PLAYER_POS " #%hu %hhd %hhd %hhu\n",
-            cs->id, cs->x, cs->y, cs->orientation + 1), true;
+        return gui_feed_player(srv, FEED_POSITION, cs), true;
     if (event->arg_count != 2)
         return append_to_output(srv, cs, "sbp\n"), true;
     player = gui_handler_get_player(srv, event);
     if (player == nullptr)
         return append_to_output(srv, cs, "sbp\n"), true;
-    vappend_to_output(srv, cs, GUI_PLAYER_POS " #%hu %hhd %hhd %hhu\n",
-        player->id, player->x, player->y, player->orientation + 1);
+    dst = reply_reserve(srv, cs, PROTO_TILE_MSG_MAX_LEN);
+    if (dst != nullptr)
+        reply_commit(srv, cs, proto_ppo(dst, player->id,
+            (uint8_t []){ player->x, player->y }, player->orientation));
     return true;
 }
 
@@ -44,11 +48,12 @@ bool gui_player_get_level_handler(server_t *srv, const event_t *event)
 {
     client_state_t *cs = event_get_client(srv, event);
     client_state_t *player;
+    char *dst;
 
     if (cs == nullptr)
         return false;
     if (cs->team_id != TEAM_ID_GRAPHIC) {
-        send_to_guis(srv, GUI_PLAYER_LVL " #%hu %hhu\n", cs->id, cs->tier);
+        gui_feed_player(srv, FEED_LEVEL, cs);
         return true;
     }
     if (event->arg_count != 2)
@@ -56,8 +61,9 @@ bool gui_player_get_level_handler(server_t *srv, const event_t *event)
     player = gui_handler_get_player(srv, event);
     if (player == nullptr)
         return append_to_output(srv, cs, "sbp\n"), true;
-    vappend_to_output(srv, cs,
-        GUI_PLAYER_LVL " #%hu %hhu\n", player->id, player->tier);
+    dst = reply_reserve(srv, cs, PROTO_TILE_MSG_MAX_LEN);
+    if (dst != nullptr)
+        reply_commit(srv, cs, proto_plv(dst, player->id, player->tier));
     return true;
 }
 
@@ -65,13 +71,12 @@ bool gui_player_get_inventory_handler(server_t *srv, const event_t *event)
 {
     client_state_t *cs = event_get_client(srv, event);
     client_state_t *player;
+    char *dst;
 
     if (cs == nullptr)
         return false;
     if (cs->team_id != TEAM_ID_GRAPHIC) {
-        send_to_guis(srv, GUI_PLAYER_INV " #%hd %hhu %hhu %s\n",
-            srv->cm.clients[event->client_idx].id,
-            cs->x, cs->y, serialize_inventory(&cs->inv));
+        gui_feed_player(srv, FEED_INVENTORY, cs);
         return true;
     }
     if (event->arg_count != 2)
@@ -79,7 +84,9 @@ bool gui_player_get_inventory_handler(server_t *srv, const event_t *event)
     player = gui_handler_get_player(srv, event);
     if (player == nullptr)
         return append_to_output(srv, cs, "sbp\n"), true;
-    vappend_to_output(srv, cs, GUI_PLAYER_INV " #%hd %hhu %hhu %s\n",
-        player->id, cs->x, cs->y, serialize_inventory(&cs->inv));
+    dst = reply_reserve(srv, cs, PROTO_TILE_MSG_MAX_LEN);
+    if (dst != nullptr)
+        reply_commit(srv, cs, proto_pin(dst, player->id,
+            (uint8_t []){ player->x, player->y }, &player->inv));
     return true;
 }
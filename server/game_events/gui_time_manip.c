@@ -31,7 +31,7 @@ bool gui_time_set_handler(server_t *srv, const event_t *event)
     if (endptr == arg || *endptr != '\0'
         || freq < 0 || freq > 10'000)
         return append_to_output(srv, cs, "sbp\n"), true;
-    srv->frequency = freq;
+    server_set_frequency(srv, freq);
     vappend_to_output(srv, cs, GUI_TIME_SET " %hu \n", srv->frequency);
     return true;
 }
@@ -40,4 +40,7 @@ bool gui_map_content_handler(server_t *srv, const event_t *event);
 bool gui_tile_content_handler(server_t *srv, const event_t *event);
 bool gui_team_names_handler(server_t *srv, const event_t *event);
 
+// Returns false if the client was removed, its output failing to grow
+bool gui_send_map_content(server_t *srv, client_state_t *cs);
+
 #endif /* !HANDLER_H_ */
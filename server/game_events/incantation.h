@@ -0,0 +1,73 @@
+#ifndef INCANTATION_H_
+    #define INCANTATION_H_
+
+    #include <stdint.h>
+    #include <string.h>
+
+    #include "server.h"
+
+/**
+ * @brief Half of an inventory, as a vector of signed lanes: SSE2 only
+ * compares signed integers, and a quantity never gets near 2^31.
+ */
+typedef int32_t resource_half_t [[gnu::vector_size(16)]];
+
+typedef struct {
+    inventory_t resources;
+    uint8_t player_count;
+} incantation_requirement_t;
+
+/**
+ * @brief What a tile must hold to elevate from the tier of the index + 1.
+ * The padding lane stays zero, like the one of the tiles.
+ */
+static const incantation_requirement_t INCANTATION_REQUIREMENTS[] = {
+    {{{0, 1, 0, 0, 0, 0, 0}}, 1},
+    {{{0, 1, 1, 1, 0, 0, 0}}, 2},
+    {{{0, 2, 0, 1, 0, 2, 0}}, 2},
+    {{{0, 1, 1, 2, 0, 1, 0}}, 4},
+    {{{0, 1, 2, 1, 3, 0, 0}}, 4},
+    {{{0, 1, 2, 3, 0, 1, 0}}, 6},
+    {{{0, 2, 2, 2, 2, 2, 1}}, 6},
+};
+
+/**
+ * @brief Checks that a tile holds the stones of an elevation from a tier,
+ * comparing every lane at once, without a branch.
+ *
+ * @param tile
+ * @param tier between 1 and TIER_MAX - 1
+ * @return true if no stone is missing
+ */
+static inline
+bool incantation_tile_ready(const inventory_t *tile, uint8_t tier)
+{
+    resource_half_t have[2];
+    resource_half_t need[2];
+    resource_half_t missing;
+    uint64_t words[2];
+
+    memcpy(have, tile->lanes, sizeof have);
+    memcpy(need, INCANTATION_REQUIREMENTS[tier - 1].resources.lanes,
+        sizeof need);
+    missing = (have[0] < need[0]) | (have[1] < need[1]);
+    memcpy(words, &missing, sizeof words);
+    return (words[0] | words[1]) == 0;
+}
+
+/**
+ * @brief Checks that a tile is ready for an elevation from a tier: its
+ * stones, then its players of that tier, counted by the tile index.
+ */
+static inline
+bool incantation_ready(const server_t *srv, uint8_t x, uint8_t y,
+    uint8_t tier)
+{
+    if (tier < 1 || tier >= TIER_MAX)
+        return false;
+    return incantation_tile_ready(&srv->map[y][x], tier)
+        && srv->tile_players[y][x][tier]
+            >= INCANTATION_REQUIREMENTS[tier - 1].player_count;
+}
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef MAP_RESOURCES_H_
+    #define MAP_RESOURCES_H_
+
+    #include <stdint.h>
+    #include <stdio.h>
+    #include <string.h>
+
+    #include "server.h"
+
+/** total_item_in_map holds the resources lying on the map, which the meteors
+top up to the density of each one. Every change of a tile goes through the
+helpers below, so the count never needs a scan of the map; the audit scans
+it anyway, to check that none was missed. **/
+
+// Names of the resources, in the order of inventory_t
+extern const char *const RESOURCE_NAMES[RES_COUNT];
+
+/**
+ * @brief Half of an inventory, summed lane by lane. Unsigned, so that the sum
+ * of a huge map wraps instead of overflowing.
+ */
+typedef uint32_t resource_sum_t [[gnu::vector_size(16)]];
+
+/**
+ * @brief Puts delta of a resource on a tile (takes it, when negative).
+ */
+static inline
+void map_resource_add(server_t *srv, inventory_t *tile, size_t res,
+    int32_t delta)
+{
+    tile->qnts[res] += delta;
+    srv->total_item_in_map.qnts[res] += delta;
+}
+
+/**
+ * @brief Takes every resource of an inventory from a tile that holds them,
+ * all lanes at once.
+ */
+static inline
+void map_resources_take(server_t *srv, inventory_t *tile,
+    const inventory_t *taken)
+{
+    resource_sum_t lanes[2];
+    resource_sum_t total[2];
+    resource_sum_t minus[2];
+
+    memcpy(lanes, tile->lanes, sizeof lanes);
+    memcpy(total, srv->total_item_in_map.lanes, sizeof total);
+    memcpy(minus, taken->lanes, sizeof minus);
+    for (size_t i = 0; i < 2; i++) {
+        lanes[i] -= minus[i];
+        total[i] -= minus[i];
+    }
+    memcpy(tile->lanes, lanes, sizeof lanes);
+    memcpy(srv->total_item_in_map.lanes, total, sizeof total);
+}
+
+/**
+ * @brief Sums the resources of count tiles, two tiles a step, each in two
+ * vectors of four lanes, so that four independent additions are in flight.
+ */
+static inline
+inventory_t inventory_sum(const inventory_t *tiles, size_t count)
+{
+    resource_sum_t acc[4] = { };
+    resource_sum_t step[4];
+    inventory_t sum;
+    size_t i = 0;
+
+    for (; i + 1 < count; i += 2) {
+        memcpy(step, tiles + i, sizeof step);
+        for (size_t k = 0; k < 4; k++)
+            acc[k] += step[k];
+    }
+    if (i < count) {
+        memcpy(step, tiles + i, sizeof *tiles);
+        acc[0] += step[0];
+        acc[1] += step[1];
+    }
+    acc[0] += acc[2];
+    acc[1] += acc[3];
+    memcpy(sum.lanes, acc, sizeof sum.lanes);
+    return sum;
+}
+
+/**
+ * @brief Counts the resources lying on the map, scanning it.
+ *
+ * @param srv
+ * @return inventory_t
+ */
+inventory_t map_resources_count(const server_t *srv);
+/**
+ * @brief Checks total_item_in_map against a scan of the map, printing the
+ * totals, and what drifted, on stream.
+ *
+ * @param srv
+ * @param stream
+ * @return false if the count drifted
+ */
+bool map_resources_audit(const server_t *srv, FILE *stream);
+
+#endif
@@ -1,5 +1,9 @@
+#include <string.h>
+
 #include "client/client.h"
+#include "spectator/spectator.h"
 #include "handler.h"
+#include "proto_writer.h"
 
 #define __USE_MISC
 // ^ above is for M_PI_[...]
@@ -25,6 +29,22 @@ int get_relative_sound_direction(
     return (int)fmod((rel_angle / M_PI_4), 8);
 }
 
+static
+void send_message(server_t *srv, client_state_t *author,
+    client_state_t *receiver, const char *text)
+{
+    size_t len = strlen(text);
+    char *dst = reply_reserve(srv, receiver,
+        len + SSTR_LEN("message 8, \n"));
+
+    if (dst == nullptr)
+        return;
+    dst = proto_u32(PROTO_LIT(dst, "message "),
+        get_relative_sound_direction(srv, author, receiver));
+    reply_commit(srv, receiver,
+        PROTO_LIT(proto_str(PROTO_LIT(dst, ", "), text, len), "\n"));
+}
+
 bool player_broadcast_handler(server_t *srv, const event_t *event)
 {
     client_state_t *cs = event_get_client(srv, event);
@@ -36,13 +56,10 @@ bool player_broadcast_handler(server_t *srv, const event_t *event)
     for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++) {
         if (cs->id == srv->cm.clients[i].id)
             continue;
-        vappend_to_output(srv, &srv->cm.clients[i],
-            "message %d, %s\n",
-            get_relative_sound_direction(srv, cs, &srv->cm.clients[i]),
-            event->command[1]);
+        send_message(srv, cs, srv->cm.clients + i, event->command[1]);
     }
-    send_to_guis(srv, "pbc #%hd %s\n",
-        srv->cm.clients[event->client_idx].id, event->command[1]);
+    gui_feed(srv, &(feed_t){ .type = FEED_BROADCAST, .id = cs->id },
+        event->command[1]);
     append_to_output(srv, cs, "ok\n");
     return true;
 }
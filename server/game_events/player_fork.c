@@ -1,5 +1,6 @@
 #include <stdio.h>
 
+#include "spectator/spectator.h"
 #include "utils/resizable_array.h"
 
 #include "client/client.h"
@@ -11,7 +12,7 @@ static constexpr const uint64_t EGG_HATCH = 600;
 bool player_fork_handler(server_t *srv, const event_t *event)
 {
     client_state_t *cs = event_get_client(srv, event);
-    uint64_t interval_sec = (EGG_HATCH * MICROSEC_IN_SEC) / srv->frequency;
+    uint64_t interval = EGG_HATCH * GAME_TIME_UNIT;
 
     if (cs == nullptr)
         return false;
@@ -20,11 +21,12 @@ bool player_fork_handler(server_t *srv, const event_t *event)
         perror("Failed to ensure capacity for eggs array\n");
         return false;
     }
-    srv->eggs.buff[srv->eggs.nmemb] = (egg_t){get_timestamp() + interval_sec,
+    srv->eggs.buff[srv->eggs.nmemb] = (egg_t){game_now(srv) + interval,
         .team_id = cs->team_id, .x = cs->x, .y = cs->y};
     srv->eggs.nmemb++;
-    send_to_guis(srv, "enw #%zu #%hu %hhu %hhu\n",
-        srv->eggs.nmemb, event->client_idx, cs->x, cs->y);
+    gui_feed(srv, &(feed_t){ .type = FEED_EGG_LAID, .x = cs->x, .y = cs->y,
+        .team_id = cs->team_id, .id = event->client_idx,
+        .index = srv->eggs.nmemb }, nullptr);
     append_to_output(srv, cs, "ok\n");
     return true;
 }
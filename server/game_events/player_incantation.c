@@ -2,46 +2,18 @@
 #include <stdio.h>
 
 #include "client/client.h"
+#include "spectator/spectator.h"
 #include "event.h"
 #include "handler.h"
+#include "incantation.h"
+#include "map_resources.h"
 #include "names.h"
-
-struct requirement_s {
-    inventory_t resources;
-    uint8_t player_count;
-};
-
-static const struct requirement_s INCANTATION_REQUIREMENTS[] = {
-    {{{0, 1, 0, 0, 0, 0, 0}}, 1},
-    {{{0, 1, 1, 1, 0, 0, 0}}, 2},
-    {{{0, 2, 0, 1, 0, 2, 0}}, 2},
-    {{{0, 1, 1, 2, 0, 1, 0}}, 4},
-    {{{0, 1, 2, 1, 3, 0, 0}}, 4},
-    {{{0, 1, 2, 3, 0, 1, 0}}, 6},
-    {{{0, 2, 2, 2, 2, 2, 1}}, 6},
-};
+#include "proto_writer.h"
 
 static constexpr const size_t INCANTATION = 300;
 
-static
-bool has_enough_resources(server_t *srv, uint8_t x, uint8_t y, uint8_t level)
-{
-    const struct requirement_s *req;
-    size_t player_count = 0;
-
-    if (level < 1 || level > 7)
-        return false;
-    req = &INCANTATION_REQUIREMENTS[level - 1];
-    for (size_t i = 0; i < RES_COUNT; i++)
-        if (srv->map[y][x].qnts[i] < req->resources.qnts[i])
-            return false;
-    for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++)
-        if (srv->cm.clients[i].x == x
-            && srv->cm.clients[i].y == y
-            && srv->cm.clients[i].tier == level)
-            player_count++;
-    return player_count >= req->player_count;
-}
+// Players of the top tier a team needs to win
+static constexpr const size_t WINNING_PLAYERS = 6;
 
 static
 void send_to_participants(server_t *srv, client_state_t *cs,
@@ -59,26 +31,29 @@ void send_to_participants(server_t *srv, client_state_t *cs,
         )
             continue;
         append_to_output(srv, client, message);
+        player_census_add(srv, client, -end);
         client->tier += end;
+        player_census_add(srv, client, end);
         client->is_in_incantation = !end;
         if (!end)
             continue;
-        send_to_guis(srv, "plv %u %hhu\n", client->id, client->tier);
+        gui_feed_player(srv, FEED_LEVEL, client);
     }
 }
 
 static
 bool player_incantation_end_schedule(server_t *srv, const event_t *event)
 {
-    uint64_t interval = (INCANTATION * MICROSEC_IN_SEC) / srv->frequency;
+    uint64_t interval = INCANTATION * GAME_TIME_UNIT;
     event_t new_event = {
-        .timestamp = get_timestamp() + interval,
+        .timestamp = game_now(srv) + interval,
         .client_idx = event->client_idx,
         .client_id = event->client_id,
-        .command = { PLAYER_END_INCANTATION }
+        .command = { PLAYER_END_INCANTATION },
+        .opcode = metrics_opcode(PLAYER_END_INCANTATION)
     };
 
-    if (!event_heap_push(&srv->events, &new_event)) {
+    if (!event_queue_push(&srv->events, &new_event, LANE_ACTION)) {
         perror("Failed to schedule incantation end event");
         return false;
     }
@@ -93,17 +68,18 @@ void player_lock_helper(
     const event_t *event
 )
 {
-    uint64_t interval = (INCANTATION * MICROSEC_IN_SEC) / srv->frequency;
+    uint64_t interval = INCANTATION * GAME_TIME_UNIT;
     event_t new_event = {
-        .timestamp = get_timestamp() + interval,
+        .timestamp = game_now(srv) + interval,
         .client_idx = idx,
         .client_id = cs->id,
-        .command = { PLAYER_LOCK }
+        .command = { PLAYER_LOCK },
+        .opcode = metrics_opcode(PLAYER_LOCK)
     };
 
     if (event->client_id == (int)cs->id)
         return;
-    if (!event_heap_push(&srv->events, &new_event)) {
+    if (!event_queue_push(&srv->events, &new_event, LANE_ACTION)) {
         perror("Failed to schedule player lock event");
         return;
     }
@@ -116,45 +92,39 @@ bool player_start_incentation_handler(server_t *srv, const event_t *event)
     if (cs == nullptr)
         return false;
     if (event->arg_count != 1
-        || !has_enough_resources(srv, cs->x, cs->y, cs->tier))
+        || !incantation_ready(srv, cs->x, cs->y, cs->tier))
         return append_to_output(srv, cs, "ko\n"), true;
-    send_to_guis(srv, "pic %hhu %hhu %hhu", cs->x, cs->y, cs->tier);
+    gui_feed(srv, &(feed_t){ .type = FEED_INCANTATION, .x = cs->x,
+        .y = cs->y, .tier = cs->tier }, nullptr);
     send_to_participants(srv, cs, "Elevation underway\n", 0);
     for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++)
         if (srv->cm.clients[i].x == cs->x
             && srv->cm.clients[i].y == cs->y
-            && srv->cm.clients[i].tier == cs->tier
-        ) {
-            send_to_guis(srv, " #%d", srv->cm.clients[i].id);
+            && srv->cm.clients[i].tier == cs->tier)
             player_lock_helper(srv, &srv->cm.clients[i], i, event);
-        }
-    send_to_guis(srv, "\n");
     return player_incantation_end_schedule(srv, event);
 }
 
+static
+void report_incantation_end(server_t *srv, const client_state_t *cs)
+{
+    gui_feed(srv, &(feed_t){ .type = FEED_INCANTATION_END, .x = cs->x,
+        .y = cs->y, .tier = cs->tier }, nullptr);
+}
+
 static
 void game_check_end(server_t *srv)
 {
-    uint8_t count_tier8 = 0;
-    client_state_t *player;
-    size_t j = 0;
-
-    for (; srv->team_names[j] != nullptr; j++) {
-        for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++) {
-            player = &srv->cm.clients[i];
-            count_tier8 += player->tier == 8 && player->team_id == j;
-        }
-        if (count_tier8 == 6)
+    size_t j = TEAM_ID_GRAPHIC + 1;
+
+    for (; srv->team_names[j] != nullptr; j++)
+        if (srv->team_tiers[j][TIER_MAX] >= WINNING_PLAYERS)
             break;
-        count_tier8 = 0;
-    }
-    if (count_tier8 == 6) {
-        send_to_guis(srv, "seg %s\n", srv->team_names[j]);
-        for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++) {
-            player = &srv->cm.clients[i];
-            append_to_output(srv, player, "death\n");
-        }
-    }
+    if (srv->team_names[j] == nullptr)
+        return;
+    gui_feed(srv, &(feed_t){ .type = FEED_GAME_END, .index = j }, nullptr);
+    for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++)
+        append_to_output(srv, &srv->cm.clients[i], "death\n");
 }
 
 bool player_end_incentation_handler(server_t *srv, const event_t *event)
@@ -164,17 +134,17 @@ bool player_end_incentation_handler(server_t *srv, const event_t *event)
 
     if (cs == nullptr)
         return false;
-    if (!has_enough_resources(srv, cs->x, cs->y, cs->tier)) {
-        send_to_guis(srv, "pie %hhu %hhu %hhu\n", cs->x, cs->y, cs->tier);
-        append_to_output(srv, cs, "ko\n");
-        return true;
-    }
-    snprintf(buff, sizeof(buff), "Current level: %d\n", cs->tier + 1);
-    for (size_t i = 0; i < RES_COUNT; i++)
-        srv->map[cs->y][cs->x].qnts[i] -=
-            INCANTATION_REQUIREMENTS[cs->tier - 1].resources.qnts[i];
+    if (!incantation_ready(srv, cs->x, cs->y, cs->tier))
+        return report_incantation_end(srv, cs),
+            append_to_output(srv, cs, "ko\n"), true;
+    *PROTO_LIT(proto_u32(PROTO_LIT(buff, "Current level: "), cs->tier + 1),
+        "\n") = '\0';
+    map_resources_take(srv, &srv->map[cs->y][cs->x],
+        &INCANTATION_REQUIREMENTS[cs->tier - 1].resources);
+    gui_feed(srv, &(feed_t){ .type = FEED_TILE, .x = cs->x, .y = cs->y,
+        .tile = srv->map[cs->y][cs->x] }, nullptr);
     send_to_participants(srv, cs, buff, 1);
-    send_to_guis(srv, "pie %hhu %hhu %hhu\n", cs->x, cs->y, cs->tier);
+    report_incantation_end(srv, cs);
     game_check_end(srv);
     return true;
 }
@@ -1,7 +1,8 @@
-#include <stdio.h>
+#include <string.h>
 
 #include "client/client.h"
 #include "handler.h"
+#include "proto_writer.h"
 
 static
 const char *INVENTORY_RESSOURCE_NAMES[RES_COUNT] = {
@@ -14,22 +15,30 @@ const char *INVENTORY_RESSOURCE_NAMES[RES_COUNT] = {
     "thystame"
 };
 
+// The longest name, a quantity and a separator per resource, and brackets
+static constexpr const size_t INVENTORY_REPLY_MAX_LEN = RES_COUNT
+    * (SSTR_LEN("deraumere , ") + PROTO_U32_MAX_LEN) + SSTR_LEN("[]\n");
+
 bool player_inventory_handler(server_t *srv, const event_t *event)
 {
     client_state_t *cs = event_get_client(srv, event);
-    uint32_t *slots = cs->inv.qnts;
+    const char *name;
+    char *dst;
 
     if (cs == nullptr)
         return false;
     if (event->arg_count != 1)
         return append_to_output(srv, cs, "ko\n"), true;
-    vappend_to_output(srv, cs, "[");
+    dst = reply_reserve(srv, cs, INVENTORY_REPLY_MAX_LEN);
+    if (dst == nullptr)
+        return true;
+    dst = PROTO_LIT(dst, "[");
     for (size_t i = 0; i < RES_COUNT; i++) {
-        if (i)
-            vappend_to_output(srv, cs, ", ");
-        vappend_to_output(srv, cs, "%s %u",
-            INVENTORY_RESSOURCE_NAMES[i], slots[i]);
+        name = INVENTORY_RESSOURCE_NAMES[i];
+        dst = proto_str(i ? PROTO_LIT(dst, ", ") : dst, name, strlen(name));
+        *dst = ' ';
+        dst = proto_u32(dst + 1, cs->inv.qnts[i]);
     }
-    vappend_to_output(srv, cs, "]\n");
+    reply_commit(srv, cs, PROTO_LIT(dst, "]\n"));
     return true;
 }
@@ -3,45 +3,91 @@
 #include <stdlib.h>
 
 #include "client/client.h"
+#include "spectator/spectator.h"
 #include "handler.h"
 #include "names.h"
 #include "server.h"
 
-static constexpr const size_t FOOD_SURVIVAL = 126;
+/** Instead of a death event per player, rescheduled at each meal, players
+are spread over FOOD_PERIOD buckets by the tick they eat on. A single sweep
+is queued, on the next tick whose bucket holds players: it starves those of
+the phase left without food, feeds the others in one pass, and reports the
+meals to the GUIs as one batch. **/
 
+/**
+ * @brief Queues the sweep of a tick, unless an earlier one is armed. The
+ * sweep it replaces stays queued, but fires as a stale no-op.
+ */
 static
-bool death_rescedule(server_t *srv, const event_t *event)
+bool food_wheel_arm(server_t *srv, uint64_t tick)
 {
-    uint64_t interval = (FOOD_SURVIVAL * MICROSEC_IN_SEC) / srv->frequency;
-    client_state_t *cs = event_get_client(srv, event);
-    event_t new = {
-        .timestamp = get_timestamp() + interval,
-        .client_idx = event->client_idx,
-        .client_id = event->client_id,
-        .command = { PLAYER_DEATH }
-    };
-
-    if (cs == nullptr)
-        return false;
-    cs->inv.food--;
-    gui_player_get_inventory_handler(srv, event);
-    if (!event_heap_push(&srv->events, &new)) {
-        perror("Failed to reschedule death event");
+    food_wheel_t *wheel = &srv->food;
+    event_t sweep = { .client_idx = 0, .client_id = 0,
+        .command = { PLAYER_DEATH }, .opcode = metrics_opcode(PLAYER_DEATH),
+        .timestamp = tick * GAME_TIME_UNIT };
+
+    if (wheel->armed && wheel->due_tick <= tick)
+        return true;
+    wheel->armed = true;
+    wheel->due_tick = tick;
+    if (!event_queue_push(&srv->events, &sweep, LANE_TIMER)) {
+        perror("Failed to schedule the food sweep");
         return false;
     }
     return true;
 }
 
+bool food_wheel_arm_next(server_t *srv)
+{
+    for (uint64_t tick = srv->food.tick + 1;
+        tick <= srv->food.tick + FOOD_PERIOD; tick++)
+        if (srv->food.bucket[tick % FOOD_PERIOD] > 0)
+            return food_wheel_arm(srv, tick);
+    return true;
+}
+
+bool food_wheel_join(server_t *srv, client_state_t *cs)
+{
+    uint64_t tick = game_now(srv) / GAME_TIME_UNIT + 1;
+
+    cs->meal_phase = tick % FOOD_PERIOD;
+    food_wheel_count(srv, cs, 1);
+    return food_wheel_arm(srv, tick);
+}
+
+static
+void starve(server_t *srv, uint32_t idx)
+{
+    uint32_t id = srv->cm.clients[idx].id;
+
+    append_to_output(srv, srv->cm.clients + idx, "dead\n");
+    write_client(srv, idx);
+    if (idx < srv->cm.count && srv->cm.clients[idx].id == id)
+        remove_client(srv, idx);
+}
+
+/**
+ * Players are starved from the last one, so that the one a removal moves
+ * in their place was already checked.
+ */
 bool player_death_handler(server_t *srv, const event_t *event)
 {
-    client_state_t *cs = event_get_client(srv, event);
+    food_wheel_t *wheel = &srv->food;
+    client_state_t *cs;
+    uint8_t phase = wheel->due_tick % FOOD_PERIOD;
 
-    if (cs == nullptr)
-        return false;
-    if (cs->inv.food > 0)
-        return death_rescedule(srv, event);
-    append_to_output(srv, cs, "dead\n");
-    write_client(srv, event->client_idx);
-    remove_client(srv, event->client_idx);
-    return true;
+    if (!wheel->armed || event->timestamp != wheel->due_tick * GAME_TIME_UNIT)
+        return true;
+    wheel->armed = false;
+    wheel->tick = wheel->due_tick;
+    for (size_t i = srv->cm.count; i-- > srv->cm.idx_of_players;)
+        if (srv->cm.clients[i].meal_phase == phase
+            && srv->cm.clients[i].inv.food == 0)
+            starve(srv, i);
+    for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++) {
+        cs = srv->cm.clients + i;
+        cs->inv.food -= cs->meal_phase == phase;
+    }
+    gui_feed(srv, &(feed_t){ .type = FEED_MEALS, .index = phase }, nullptr);
+    return food_wheel_arm_next(srv);
 }
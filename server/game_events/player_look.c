@@ -10,7 +10,6 @@ static const char *RES_NAMES[RES_COUNT] = {
     "food", "linemate", "deraumere", "sibur", "mendiane", "phiras", "thystame"
 };
 
-static constexpr const size_t TIER_MAX = 8;
 static constexpr const size_t TIER_MAX_AREA = (TIER_MAX + 1) * (TIER_MAX + 1);
 
 static
@@ -81,7 +80,7 @@ void serialize_item_on_tite(
             continue;
         for (size_t j = 0; j < tile->qnts[i]; j++) {
             append_to_output(srv, cs, prev ? " " : "");
-            vappend_to_output(srv, cs, "%s", RES_NAMES[i]);
+            append_to_output(srv, cs, RES_NAMES[i]);
             prev = true;
         }
     }
@@ -96,14 +95,14 @@ void serialiaze_tile(
         count_player_on_tile(srv, coords[idx][0], coords[idx][1]);
 
     for (size_t i = 0; i < players_on_tile; i++) {
-        vappend_to_output(srv, cs, "%splayer", has_prev ? " " : "");
+        append_to_output(srv, cs, has_prev ? " player" : "player");
         has_prev = true;
     }
     for (size_t i = 0; i < srv->eggs.nmemb; i++) {
         if (srv->eggs.buff[i].x != coords[idx][0]
             || srv->eggs.buff[i].y != coords[idx][1])
             continue;
-        vappend_to_output(srv, cs, "%segg", has_prev ? " " : "");
+        append_to_output(srv, cs, has_prev ? " egg" : "egg");
         has_prev = true;
     }
     serialize_item_on_tite(srv, cs, coords[idx], has_prev);
@@ -1,10 +1,12 @@
 #include "client/client.h"
+#include "spectator/spectator.h"
 #include "handler.h"
 
 static
 void player_move(
     server_t *srv, client_state_t *player, orientation_t orientation)
 {
+    tile_players_add(srv, player, -1);
     if (orientation == OR_NORTH)
         player->y = (player->y + srv->map_height - 1) % srv->map_height;
     if (orientation == OR_EAST)
@@ -13,6 +15,7 @@ void player_move(
         player->y = (player->y + 1) % srv->map_height;
     if (orientation == OR_WEST)
         player->x = (player->x + srv->map_width - 1) % srv->map_width;
+    tile_players_add(srv, player, 1);
 }
 
 bool player_move_forward_handler(server_t *srv, const event_t *event)
@@ -83,7 +86,8 @@ void destroy_ejected_eggs(server_t *srv, client_state_t *cs)
 {
     for (size_t i = 0; i < srv->eggs.nmemb; i++) {
         if (srv->eggs.buff[i].x == cs->x && srv->eggs.buff[i].y == cs->y) {
-            send_to_guis(srv, "edi %hu\n", srv->eggs.buff[i].id);
+            gui_feed(srv, &(feed_t){ .type = FEED_EGG_GONE,
+                .id = srv->eggs.buff[i].id, .index = i }, nullptr);
             srv->eggs.buff[i] = srv->eggs.buff[srv->eggs.nmemb - 1];
             srv->eggs.nmemb--;
         }
@@ -107,8 +111,7 @@ bool player_eject_handler(server_t *srv, const event_t *event)
         player_move(srv, pl, cs->orientation);
         vappend_to_output(srv, pl, "eject: %hhu\n",
             relative_eject_direction(pl->orientation, cs->orientation));
-        send_to_guis(srv, "pex %hu\nppo %hu %hhu %hhu %hhu\n",
-            pl->id, pl->id, pl->x, pl->y, pl->orientation);
+        gui_feed_player(srv, FEED_EXPULSION, pl);
     }
     destroy_ejected_eggs(srv, cs);
     return true;
@@ -2,10 +2,22 @@
 #include <string.h>
 
 #include "handler.h"
+#include "map_resources.h"
 #include "client/client.h"
+#include "spectator/spectator.h"
 
 static constexpr const uint8_t INVALID_OBJECT_ID = 255;
 
+static
+void feed_object(server_t *srv, const client_state_t *cs,
+    const inventory_t *tile)
+{
+    feed_t feed = feed_of_player(FEED_OBJECT, cs);
+
+    feed.tile = *tile;
+    gui_feed(srv, &feed, nullptr);
+}
+
 static
 uint8_t get_ressource_id(char *command)
 {
@@ -27,23 +39,20 @@ bool player_take_object_handler(server_t *srv, const event_t *event)
 {
     uint8_t object_id = get_ressource_id(event->command[1]);
     client_state_t *cs = event_get_client(srv, event);
-    inventory_t *tile = &srv->map[cs->y][cs->x];
+    inventory_t *tile;
 
     if (cs == nullptr)
         return false;
+    tile = &srv->map[cs->y][cs->x];
     if (event->arg_count != 2
         || object_id == INVALID_OBJECT_ID
         || tile->qnts[object_id] == 0
-    ) {
-        append_to_output(srv, cs, "ko\n");
-        return true;
-    }
-    tile->qnts[object_id]--;
+    )
+        return append_to_output(srv, cs, "ko\n"), true;
+    map_resource_add(srv, tile, object_id, -1);
     cs->inv.qnts[object_id]++;
     append_to_output(srv, cs, "ok\n");
-    send_to_guis(srv, "pin #%hu %hhu %hhu %s\nbct %hhu %hhu %s\n",
-        cs->id, cs->x, cs->y, serialize_inventory(&cs->inv),
-        cs->x, cs->y, serialize_inventory(tile));
+    feed_object(srv, cs, tile);
     return true;
 }
 
@@ -60,12 +69,9 @@ bool player_set_object_handler(server_t *srv, const event_t *event)
         return append_to_output(srv, cs, "ko\n"), true;
     if (cs->inv.qnts[object_id] == 0)
         return append_to_output(srv, cs, "ko\n"), true;
-    tile->qnts[object_id]++;
+    map_resource_add(srv, tile, object_id, 1);
     cs->inv.qnts[object_id]--;
-    srv->total_item_in_map.qnts[object_id]++;
     append_to_output(srv, cs, "ok\n");
-    send_to_guis(srv, "pin #%hu %hhu %hhu %s\nbct %hhu %hhu %s\n",
-        cs->id, cs->x, cs->y, serialize_inventory(&cs->inv),
-        cs->x, cs->y, serialize_inventory(tile));
+    feed_object(srv, cs, tile);
     return true;
 }
@@ -12,7 +12,7 @@ bool team_available_slot_handler(server_t *srv, const event_t *event)
         return append_to_output(srv, cs, "ko\n"), true;
     for (size_t i = 0; i < srv->eggs.nmemb; i++)
         count += srv->eggs.buff[i].team_id == cs->team_id
-            && srv->eggs.buff[i].hatch <= get_timestamp();
+            && srv->eggs.buff[i].hatch <= game_now(srv);
     vappend_to_output(srv, cs, "%zu\n", count);
     return true;
 }
@@ -21,7 +21,7 @@ static void heapify_up(event_heap_t *heap, int idx)
 
     while (idx > 0) {
         parent = (idx - 1) / 2;
-        if (heap->buff[parent].timestamp <= heap->buff[idx].timestamp)
+        if (!event_before(&heap->buff[idx], &heap->buff[parent]))
             break;
         swap(&heap->buff[parent], &heap->buff[idx]);
         idx = parent;
@@ -39,10 +39,10 @@ static void heapify_down(event_heap_t *heap, size_t idx)
         right = 2 * idx + 2;
         smallest = idx;
         if (left < heap->nmemb
-            && heap->buff[left].timestamp < heap->buff[smallest].timestamp)
+            && event_before(&heap->buff[left], &heap->buff[smallest]))
             smallest = left;
         if (right < heap->nmemb
-            && heap->buff[right].timestamp < heap->buff[smallest].timestamp)
+            && event_before(&heap->buff[right], &heap->buff[smallest]))
             smallest = right;
         if (smallest == idx)
             break;
@@ -56,61 +56,46 @@ bool event_heap_init(event_heap_t *heap)
     heap->buff = nullptr;
     heap->nmemb = 0;
     heap->capacity = 0;
+    heap->next_seq = 0;
     return sized_struct_ensure_capacity(
         (resizable_array_t *)heap, 0, sizeof(event_t));
 }
 
 void event_heap_free(event_heap_t *heap)
 {
-    for (size_t i = 0; i < heap->nmemb; i++) {
-        for (size_t j = 0; heap->buff[i].command[j] != nullptr; j++) {
-            free(heap->buff[i].command[j]);
-            heap->buff[i].command[j] = nullptr;
-        }
-    }
+    for (size_t i = 0; i < heap->nmemb; i++)
+        event_words_free(heap->buff + i);
     free(heap->buff);
     heap->buff = nullptr;
     heap->nmemb = 0;
     heap->capacity = 0;
 }
 
-bool event_heap_push(event_heap_t *heap, const event_t *event)
+bool event_heap_insert(event_heap_t *heap, const event_t *event,
+    uint32_t seq)
 {
-    size_t i = 0;
-
     if (!sized_struct_ensure_capacity(
         (resizable_array_t *)heap, 1, sizeof(event_t)))
         return false;
-    for (; event->command[i] != nullptr; i++) {
-        heap->buff[heap->nmemb].command[i] = strdup(event->command[i]);
-        if (heap->buff[heap->nmemb].command[i] == nullptr) {
-            DEBUG_MSG("Failed to allocate memory for command string");
-            return false;
-        }
-    }
-    heap->buff[heap->nmemb].command[i] = nullptr;
-    heap->buff[heap->nmemb].arg_count = i;
-    heap->buff[heap->nmemb].client_idx = event->client_idx;
-    heap->buff[heap->nmemb].timestamp = event->timestamp;
-    heap->buff[heap->nmemb].client_id = event->client_id;
+    if (!event_copy(heap->buff + heap->nmemb, event, seq))
+        return false;
     heapify_up(heap, heap->nmemb);
     heap->nmemb++;
     return true;
 }
 
-event_t event_heap_pop(event_heap_t *heap)
+bool event_heap_push(event_heap_t *heap, const event_t *event)
 {
-    event_t ret = {0};
+    return event_heap_insert(heap, event, heap->next_seq++);
+}
 
+event_t event_heap_pop(event_heap_t *heap)
+{
     if (heap->nmemb == 0)
-        return ret;
-    ret = heap->buff[0];
+        return (event_t){ };
+    event_words_free(heap->buff);
     heap->nmemb--;
     if (heap->nmemb > 0) {
-        for (size_t i = 0; heap->buff[0].command[i] != nullptr; i++) {
-            free(heap->buff[0].command[i]);
-            heap->buff[0].command[i] = nullptr;
-        }
         heap->buff[0] = heap->buff[heap->nmemb];
         heapify_down(heap, 0);
     }
@@ -125,7 +110,7 @@ client_state_t *event_get_client(server_t *srv, event_t const *event)
         return nullptr;
     if (maybe_client->id == (uint32_t)event->client_id)
         return maybe_client;
-    for (size_t i = 0; i < srv->cm.count; i++)
+    for (size_t i = 1; i < srv->cm.count; i++)
         if (srv->cm.clients[i].id == (uint32_t)event->client_id)
             return srv->cm.clients + i;
     return nullptr;
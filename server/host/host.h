@@ -0,0 +1,109 @@
+#ifndef HOST_H_
+    #define HOST_H_
+
+    #include <poll.h>
+    #include <pthread.h>
+    #include <stdbool.h>
+    #include <stddef.h>
+    #include <stdint.h>
+
+    #include "server.h"
+    #include "server_args_parser.h"
+
+/** With -M, a single process hosts several independent matches. A lobby, on
+the main thread, owns the game port: it greets each connection, reads its
+first line, "<match>:<team>", and hands the socket over to the thread of
+that match along with "<team>". Each match is a whole server_t, with its own
+world, event queues, clock and buffer pool, running the usual loop on its
+own thread, where the inbox it reads the handoffs from takes the place of
+the listening socket. **/
+
+/**
+ * @brief Longest first line the lobby reads, "<match>:" included.
+ */
+static constexpr const size_t HANDOFF_LINE_MAX = 256;
+
+// Values of handoff_t.fd that carry an order instead of a connection
+static constexpr const int HANDOFF_STOP = -1;
+static constexpr const int HANDOFF_DUMP_STATS = -2;
+
+/**
+ * @brief A connection passed from the lobby to a match, along with the line
+ * it answered WELCOME with. Small enough to go through a pipe in one write.
+ * The lobby also keeps the line of each connection it is still reading in
+ * one of them.
+ */
+typedef struct {
+    int fd; // Or one of the orders below
+    uint16_t len;
+    char line[HANDOFF_LINE_MAX];
+} handoff_t;
+
+typedef struct {
+    server_t *srv;
+    pthread_t thread;
+    int inbox[2]; // Pipe the lobby writes the handoffs to
+    const params_t *params;
+    size_t index;
+    bool started;
+} match_t;
+
+typedef struct {
+    volatile bool is_running;
+    int listen_fd;
+    match_t *matches;
+    size_t match_count;
+    struct pollfd *pfds; // The listener, then the connections of pending
+    handoff_t *pending; // Connections the lobby waits for the line of
+    size_t pending_count;
+    size_t pending_capacity;
+} host_t;
+
+/**
+ * @brief Serves p->match_count matches from this process until SIGINT or
+ * SIGTERM.
+ *
+ * @param p
+ * @return false if the port or a match could not be set up
+ */
+bool host_run(params_t *p);
+/**
+ * @brief Builds the world of every match, then starts their threads.
+ *
+ * @param host
+ * @param p
+ * @return false if a match could not be set up
+ */
+bool host_start_matches(host_t *host, params_t *p);
+/**
+ * @brief Asks every match to stop, waits for them and releases them.
+ *
+ * @param host
+ */
+void host_stop_matches(host_t *host);
+/**
+ * @brief Sends an order to a match. Async-signal-safe.
+ *
+ * @param match
+ * @param order HANDOFF_STOP or HANDOFF_DUMP_STATS
+ * @return false if the inbox of the match is full
+ */
+bool match_order(const match_t *match, int order);
+/**
+ * @brief Adopts the clients the lobby handed over to a match, each joining
+ * the team of its line. Called on the thread of the match.
+ *
+ * @param srv
+ */
+void match_adopt_clients(server_t *srv);
+/**
+ * @brief Registers the host the signals are reported to, then installs the
+ * handlers: SIGINT and SIGTERM stop the lobby, SIGUSR1 is passed on to every
+ * match.
+ *
+ * @param host
+ * @return false if sigaction failed
+ */
+bool install_host_signal_handlers(host_t *host);
+
+#endif /* !HOST_H_ */
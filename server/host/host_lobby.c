@@ -0,0 +1,187 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "utils/common_macros.h"
+#include "utils/debug.h"
+
+#include "host.h"
+#include "server.h"
+
+/** The lobby only reads the first line of a connection, without consuming
+anything past its newline: the commands a client sends right after it stay
+in the socket for the match to read. **/
+
+static
+bool lobby_grow(host_t *host)
+{
+    size_t capacity = host->pending_capacity * 2 + 16;
+    struct pollfd *pfds = realloc(host->pfds, (capacity + 1) * sizeof *pfds);
+    handoff_t *pending;
+
+    if (pfds == nullptr)
+        return false;
+    host->pfds = pfds;
+    pending = realloc(host->pending, capacity * sizeof *pending);
+    if (pending == nullptr)
+        return false;
+    host->pending = pending;
+    host->pending_capacity = capacity;
+    return true;
+}
+
+/**
+ * @brief Forgets a pending connection. Unless reply is nullptr, which means
+ * the connection was handed over, the reply is sent and it gets closed.
+ */
+static
+void lobby_drop(host_t *host, size_t i, const char *reply)
+{
+    if (reply != nullptr) {
+        send(host->pending[i].fd, reply, strlen(reply),
+            MSG_DONTWAIT | MSG_NOSIGNAL);
+        close(host->pending[i].fd);
+    }
+    host->pending_count--;
+    host->pending[i] = host->pending[host->pending_count];
+    host->pfds[i + 1] = host->pfds[host->pending_count + 1];
+}
+
+static
+bool lobby_greet(host_t *host, int fd)
+{
+    if (host->pending_count == host->pending_capacity && !lobby_grow(host))
+        return close(fd), perror("Can't register a connection"), false;
+    host->pending[host->pending_count] = (handoff_t){ .fd = fd };
+    host->pfds[host->pending_count + 1] = (struct pollfd){ .fd = fd,
+        .events = POLLIN };
+    host->pending_count++;
+    send(fd, "WELCOME\n", SSTR_LEN("WELCOME\n"), MSG_DONTWAIT | MSG_NOSIGNAL);
+    return true;
+}
+
+static
+void lobby_accept(host_t *host)
+{
+    int fd;
+
+    for (;;) {
+        fd = accept4(host->listen_fd, nullptr, nullptr,
+            SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0 && errno != EINTR && errno != ECONNABORTED)
+            return;
+        if (fd >= 0 && !lobby_greet(host, fd))
+            return;
+    }
+}
+
+/**
+ * @brief Passes a connection whose line is complete to the match it names,
+ * the line being stripped of "<match>:" and of its newline.
+ */
+static
+void lobby_dispatch(host_t *host, size_t i)
+{
+    handoff_t *conn = host->pending + i;
+    char *end;
+    size_t match = strtoul(conn->line, &end, 10);
+    size_t skip = end + 1 - conn->line;
+
+    if (end == conn->line || *end != ':' || match >= host->match_count) {
+        lobby_drop(host, i, "ko\n");
+        return;
+    }
+    conn->len -= skip + 1;
+    memmove(conn->line, conn->line + skip, conn->len);
+    if (write(host->matches[match].inbox[1], conn, sizeof *conn) < 0) {
+        lobby_drop(host, i, "ko\n");
+        return;
+    }
+    DEBUG("Connection fd=%d handed over to match %zu", conn->fd, match);
+    lobby_drop(host, i, nullptr);
+}
+
+static
+void lobby_read(host_t *host, size_t i)
+{
+    handoff_t *conn = host->pending + i;
+    ssize_t got = recv(conn->fd, conn->line + conn->len,
+        HANDOFF_LINE_MAX - conn->len, MSG_PEEK);
+    char *newline;
+
+    if (got < 0 && (errno == EAGAIN || errno == EINTR))
+        return;
+    if (got <= 0) {
+        lobby_drop(host, i, "");
+        return;
+    }
+    newline = memchr(conn->line + conn->len, '\n', got);
+    if (newline != nullptr)
+        got = newline + 1 - (conn->line + conn->len);
+    got = recv(conn->fd, conn->line + conn->len, got, 0);
+    conn->len += got > 0 ? got : 0;
+    if (newline != nullptr)
+        lobby_dispatch(host, i);
+    else if (conn->len == HANDOFF_LINE_MAX)
+        lobby_drop(host, i, "ko\n");
+}
+
+static
+void lobby_poll(host_t *host)
+{
+    if (poll(host->pfds, host->pending_count + 1, -1) < 0) {
+        if (errno != EINTR)
+            host->is_running = false;
+        return;
+    }
+    for (size_t i = host->pending_count; i > 0; i--)
+        if (host->pfds[i].revents & (POLLIN | POLLHUP | POLLERR))
+            lobby_read(host, i - 1);
+    if (host->pfds[0].revents & POLLIN)
+        lobby_accept(host);
+}
+
+static
+bool lobby_open(host_t *host, params_t *p)
+{
+    if (p->journal_path != nullptr || p->snapshot_path != nullptr
+        || p->restore_path != nullptr || p->spectator_port != 0
+        || p->unix_path != nullptr)
+        return fprintf(stderr, "-M cannot be combined with -J, -W, -r, -G "
+            "or -U\n"), false;
+    if (p->loop_tuning != nullptr && !loop_tuning_parse(p->loop_tuning,
+        &(loop_tuning_t){ }))
+        return false;
+    SERVER_CLOCK.is_virtual = p->virtual_clock;
+    if (!install_host_signal_handlers(host))
+        return perror("Can't set signal handler"), false;
+    host->listen_fd = server_socket_listen(p->port, p->reuseport,
+        p->backlog);
+    if (host->listen_fd < 0 || !lobby_grow(host))
+        return perror("Can't open server socket"), false;
+    host->pfds[0] = (struct pollfd){ .fd = host->listen_fd, .events = POLLIN };
+    return true;
+}
+
+bool host_run(params_t *p)
+{
+    host_t host = { .is_running = true, .listen_fd = -1 };
+    bool ok = lobby_open(&host, p) && host_start_matches(&host, p);
+
+    while (ok && host.is_running)
+        lobby_poll(&host);
+    host_stop_matches(&host);
+    for (size_t i = 0; i < host.pending_count; i++)
+        close(host.pending[i].fd);
+    if (host.listen_fd >= 0)
+        close(host.listen_fd);
+    free(host.pfds);
+    free(host.pending);
+    return ok;
+}
@@ -0,0 +1,151 @@
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "client/client.h"
+#include "utils/debug.h"
+
+#include "host.h"
+#include "server.h"
+
+/** The worlds are built on the lobby thread, one after the other, so an
+error shows before anything is served and a seed gives every match the same
+map. Signals are blocked on the threads of the matches: they all reach the
+lobby, which passes them on. **/
+
+static
+void adopt_client(server_t *srv, handoff_t *handoff)
+{
+    client_state_t *client = register_client_state(srv, handoff->fd);
+
+    if (client == nullptr) {
+        close(handoff->fd);
+        perror("failed to register client");
+        return;
+    }
+    srv->accept_stats.accepted++;
+    handoff->line[handoff->len] = '\0';
+    client_process_line(srv, client, handoff->line, handoff->len);
+}
+
+void match_adopt_clients(server_t *srv)
+{
+    handoff_t handoff;
+
+    while (read(srv->self_fd, &handoff, sizeof handoff) == sizeof handoff) {
+        if (handoff.fd == HANDOFF_STOP)
+            srv->is_running = false;
+        if (handoff.fd == HANDOFF_DUMP_STATS)
+            srv->stats_requested = true;
+        if (handoff.fd >= 0)
+            adopt_client(srv, &handoff);
+    }
+}
+
+bool match_order(const match_t *match, int order)
+{
+    handoff_t handoff = { .fd = order };
+
+    return write(match->inbox[1], &handoff, sizeof handoff) > 0;
+}
+
+static
+void *match_main(void *arg)
+{
+    match_t *match = arg;
+
+    SERVER_CLOCK.is_virtual = match->params->virtual_clock;
+    server_tune_loop(match->params, match->index);
+    server_loop(match->srv);
+    server_destroy(match->srv);
+    return nullptr;
+}
+
+static
+bool match_build(match_t *match, params_t *p)
+{
+    server_t *srv = calloc(1, sizeof *srv);
+
+    match->srv = srv;
+    if (srv == nullptr)
+        return perror("Can't allocate a match"), false;
+    srv->self_fd = -1;
+    srv->is_running = true;
+    srv->is_hosted = true;
+    if (pipe2(match->inbox, O_CLOEXEC | O_NONBLOCK) < 0)
+        return perror("Can't open the inbox of a match"), false;
+    if (!server_start(srv, p))
+        return false;
+    srv->self_fd = match->inbox[0];
+    srv->cm.server_pfds[0].fd = srv->self_fd;
+    srv->cm.clients[0].fd = srv->self_fd;
+    return true;
+}
+
+static
+bool match_spawn(match_t *match, const params_t *p)
+{
+    sigset_t all;
+    sigset_t previous;
+    int err;
+
+    match->params = p;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &previous);
+    err = pthread_create(&match->thread, nullptr, match_main, match);
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+    if (err != 0)
+        return fprintf(stderr, "Can't start a match thread\n"), false;
+    match->started = true;
+    return true;
+}
+
+bool host_start_matches(host_t *host, params_t *p)
+{
+    host->matches = calloc(p->match_count, sizeof *host->matches);
+    if (host->matches == nullptr)
+        return perror("Can't allocate the matches"), false;
+    for (size_t i = 0; i < p->match_count; i++) {
+        host->matches[i].inbox[0] = -1;
+        host->matches[i].inbox[1] = -1;
+        host->matches[i].index = i;
+        host->match_count++;
+        if (!match_build(host->matches + i, p))
+            return false;
+    }
+    for (size_t i = 0; i < host->match_count; i++)
+        if (!match_spawn(host->matches + i, p))
+            return false;
+    DEBUG("Hosting %zu matches", host->match_count);
+    return true;
+}
+
+static
+void match_stop(match_t *match)
+{
+    if (match->started) {
+        while (!match_order(match, HANDOFF_STOP))
+            usleep(1000);
+        pthread_join(match->thread, nullptr);
+    } else if (match->srv != nullptr) {
+        if (match->srv->self_fd < 0 && match->inbox[0] >= 0)
+            close(match->inbox[0]);
+        server_destroy(match->srv);
+    }
+    if (match->inbox[1] >= 0)
+        close(match->inbox[1]);
+    free(match->srv);
+}
+
+void host_stop_matches(host_t *host)
+{
+    for (size_t i = 0; i < host->match_count; i++)
+        match_stop(host->matches + i);
+    free(host->matches);
+    host->matches = nullptr;
+    host->match_count = 0;
+}
@@ -0,0 +1,126 @@
+#ifndef JOURNAL_H_
+    #define JOURNAL_H_
+
+    #include <stddef.h>
+    #include <stdint.h>
+
+/**
+ * @brief Bumped whenever the layout of the header or of a record changes.
+ *
+ */
+static constexpr const uint16_t JOURNAL_VERSION = 1;
+static constexpr const char JOURNAL_MAGIC[4] = { 'Z', 'J', 'N', 'L' };
+
+/**
+ * @brief Kinds of journal records.
+ *
+ * The file is grown in zeroed chunks, so a journal cut short by a crash ends
+ * on a JOURNAL_END record all the same.
+ */
+typedef enum {
+    JOURNAL_END,
+    JOURNAL_CONNECT, // A connection was accepted
+    JOURNAL_DISCONNECT, // A client was removed
+    JOURNAL_COMMAND, // A command line was read, the payload is the line
+    JOURNAL_FIRE, // An event handler was run
+} journal_type_t;
+
+/**
+ * @brief Start of a journal: what the world was built from.
+ *
+ * It is followed by names_size bytes holding the team_count team names,
+ * reserved ones included, each one NUL-terminated.
+ */
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t frequency;
+    uint16_t seed;
+    uint8_t map_width;
+    uint8_t map_height;
+    uint8_t team_capacity;
+    uint8_t team_count;
+    uint16_t names_size;
+    uint64_t created_at; // Timestamp the eggs hatch at
+    uint64_t booted_at; // Timestamp of the first meteor
+} journal_header_t;
+
+/**
+ * @brief Fixed part of a record, followed by length bytes of payload.
+ *
+ */
+typedef struct {
+    uint64_t timestamp;
+    uint32_t client_id;
+    uint16_t length;
+    uint8_t type;
+    uint8_t opcode; // Metrics opcode of the fired event
+} journal_record_t;
+
+typedef struct journal_s journal_t;
+typedef struct server_s server_t;
+typedef struct params_s params_t;
+
+/**
+ * @brief Opens the journal of a freshly started server, if it was asked for
+ * one, and writes its header.
+ *
+ * @param srv
+ * @param p
+ * @param created_at
+ * @return false if the journal file could not be set up
+ */
+bool journal_start(server_t *srv, const params_t *p, uint64_t created_at);
+/**
+ * @brief Trims the journal to the records written and closes it.
+ *
+ * @param journal
+ */
+void journal_close(journal_t *journal);
+/**
+ * @brief Appends a record without payload. Does nothing without a journal.
+ *
+ * @param journal
+ * @param type
+ * @param client_id
+ * @param opcode
+ */
+void journal_event(journal_t *journal, journal_type_t type,
+    uint32_t client_id, uint8_t opcode);
+/**
+ * @brief Appends a command line received from a client. Does nothing
+ * without a journal.
+ *
+ * @param journal
+ * @param client_id
+ * @param line
+ * @param len
+ */
+void journal_command(journal_t *journal, uint32_t client_id,
+    const char *line, size_t len);
+/**
+ * @brief Holds the clock still until journal_unpin_clock, so that what is
+ * run in between sees the exact timestamp its record is written with.
+ * Does nothing without a journal or on a virtual clock.
+ *
+ * @param journal
+ * @return true if the clock was pinned
+ */
+bool journal_pin_clock(const journal_t *journal);
+/**
+ * @brief Lets a clock pinned by journal_pin_clock follow the wall clock
+ * again.
+ *
+ * @param pinned
+ */
+void journal_unpin_clock(bool pinned);
+/**
+ * @brief Rebuilds the world a journal was recorded on and runs its records
+ * again, without any socket, on a virtual clock.
+ *
+ * @param path
+ * @return false if the journal could not be read
+ */
+bool journal_replay(const char *path);
+
+#endif /* !JOURNAL_H_ */
@@ -0,0 +1,110 @@
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "client/client.h"
+#include "server.h"
+
+#include "journal_reader.h"
+
+static
+bool read_team_names(journal_reader_t *reader)
+{
+    char *name = reader->map + sizeof reader->header;
+    char *end = name + reader->header.names_size;
+    char *nul;
+
+    if ((size_t)(end - reader->map) > reader->size)
+        return false;
+    for (size_t i = 0; i < reader->header.team_count; i++) {
+        nul = memchr(name, '\0', end - name);
+        if (nul == nullptr)
+            return false;
+        reader->teams[i] = name;
+        name = nul + 1;
+    }
+    reader->teams[reader->header.team_count] = nullptr;
+    reader->offset = end - reader->map;
+    return true;
+}
+
+static
+bool read_header(journal_reader_t *reader)
+{
+    const journal_header_t *header = &reader->header;
+
+    if (reader->size < sizeof *header)
+        return false;
+    memcpy(&reader->header, reader->map, sizeof *header);
+    if (memcmp(header->magic, JOURNAL_MAGIC, sizeof JOURNAL_MAGIC)
+        || header->version != JOURNAL_VERSION
+        || header->map_width == 0 || header->map_width > MAP_MAX_SIDE_SIZE
+        || header->map_height == 0 || header->map_height > MAP_MAX_SIDE_SIZE
+        || header->team_count <= TEAM_ID_GRAPHIC || header->frequency == 0
+        || header->team_capacity == 0)
+        return false;
+    return read_team_names(reader);
+}
+
+bool journal_reader_open(journal_reader_t *reader, const char *path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+
+    if (fd < 0)
+        return perror(path), false;
+    if (fstat(fd, &st) < 0)
+        return close(fd), perror(path), false;
+    reader->size = st.st_size;
+    reader->map = mmap(nullptr, reader->size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (reader->map == MAP_FAILED) {
+        reader->map = nullptr;
+        return perror(path), false;
+    }
+    if (read_header(reader))
+        return true;
+    fprintf(stderr, "%s: not a version %u journal\n", path, JOURNAL_VERSION);
+    journal_reader_close(reader);
+    return false;
+}
+
+void journal_reader_params(journal_reader_t *reader, params_t *p)
+{
+    *p = (params_t){ .teams = reader->teams,
+        .registered_team_count = reader->header.team_count,
+        .frequency = reader->header.frequency,
+        .map_width = reader->header.map_width,
+        .map_height = reader->header.map_height,
+        .team_capacity = reader->header.team_capacity,
+        .seed = reader->header.seed, .virtual_clock = true,
+        .out_high_kib = 1024, .out_low_kib = 256, .out_stall_sec = 10 };
+}
+
+const char *journal_reader_next(journal_reader_t *reader,
+    journal_record_t *record)
+{
+    const char *payload = reader->map + reader->offset + sizeof *record;
+
+    if (reader->offset + sizeof *record > reader->size)
+        return nullptr;
+    memcpy(record, reader->map + reader->offset, sizeof *record);
+    if (record->type == JOURNAL_END
+        || reader->offset + sizeof *record + record->length > reader->size)
+        return nullptr;
+    reader->offset += sizeof *record + record->length;
+    return payload;
+}
+
+void journal_reader_close(journal_reader_t *reader)
+{
+    if (reader->map != nullptr)
+        munmap(reader->map, reader->size);
+    reader->map = nullptr;
+}
@@ -0,0 +1,53 @@
+#ifndef JOURNAL_READER_H_
+    #define JOURNAL_READER_H_
+
+    #include "server_args_parser.h"
+
+    #include "journal.h"
+
+/**
+ * @brief Read-side view of a journal file.
+ *
+ * The mapping is private and writable so that the team names can be handed
+ * to the server as they lie in it.
+ */
+typedef struct {
+    char *map;
+    size_t size;
+    size_t offset;
+    journal_header_t header;
+    char *teams[TEAM_COUNT_LIMIT];
+} journal_reader_t;
+
+/**
+ * @brief Maps a journal and checks its header.
+ *
+ * @param reader
+ * @param path
+ * @return false if the file is not a journal this server can read
+ */
+bool journal_reader_open(journal_reader_t *reader, const char *path);
+/**
+ * @brief Fills the parameters the journaled server was started with.
+ *
+ * @param reader
+ * @param p
+ */
+void journal_reader_params(journal_reader_t *reader, params_t *p);
+/**
+ * @brief Reads the next record.
+ *
+ * @param reader
+ * @param record
+ * @return const char* Its payload, or nullptr past the last record.
+ */
+const char *journal_reader_next(journal_reader_t *reader,
+    journal_record_t *record);
+/**
+ * @brief Unmaps the journal.
+ *
+ * @param reader
+ */
+void journal_reader_close(journal_reader_t *reader);
+
+#endif /* !JOURNAL_READER_H_ */
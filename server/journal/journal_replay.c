@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "client/client.h"
+#include "metrics/metrics.h"
+
+#include "journal_reader.h"
+#include "server.h"
+
+/** Replay rebuilds the world from the journal header, then applies the
+records in order with the virtual clock set to each record's timestamp.
+Commands go through the same parsing and scheduling code as live ones, and
+each FIRE record runs exactly one event, so that the order events fire in
+does not depend on how far apart the records are. The event about to run is
+checked against the record, any mismatch being counted as a divergence.
+
+Replies cannot go anywhere, so the output buffers are emptied every
+REPLAY_DISCARD_PERIOD records. **/
+
+static constexpr const uint64_t REPLAY_DISCARD_PERIOD = 1024;
+
+typedef struct {
+    server_t srv;
+    uint64_t records;
+    uint64_t commands;
+    uint64_t fired;
+    uint64_t divergences;
+} replay_t;
+
+static
+void replay_client(replay_t *rp, const journal_record_t *record)
+{
+    client_state_t *client = client_from_id(&rp->srv, record->client_id);
+
+    if (record->type == JOURNAL_CONNECT) {
+        client = add_client_state(&rp->srv, -1);
+        rp->divergences += client == nullptr
+            || client->id != record->client_id;
+        return;
+    }
+    if (client != nullptr)
+        remove_client(&rp->srv, client - rp->srv.cm.clients);
+}
+
+static
+void replay_command(replay_t *rp, const journal_record_t *record,
+    const char *payload)
+{
+    client_state_t *client = client_from_id(&rp->srv, record->client_id);
+    char line[CLIENT_MAX_LINE_LEN + 1];
+
+    if (client == nullptr || record->length > CLIENT_MAX_LINE_LEN) {
+        rp->divergences++;
+        return;
+    }
+    memcpy(line, payload, record->length);
+    line[record->length] = '\0';
+    client_process_line(&rp->srv, client, line, record->length);
+    rp->commands++;
+}
+
+static
+void replay_fire(replay_t *rp, const journal_record_t *record)
+{
+    const event_t *e = server_next_due_event(&rp->srv, record->timestamp);
+
+    if (e == nullptr || (uint32_t)e->client_id != record->client_id
+        || metrics_opcode(e->command[0]) != record->opcode)
+        rp->divergences++;
+    if (e != nullptr && server_fire_next_event(&rp->srv, record->timestamp))
+        rp->fired++;
+}
+
+static
+void discard_outputs(server_t *srv)
+{
+    for (size_t i = 1; i < srv->cm.count; i++)
+        if (!srv->cm.clients[i].close_after_flush)
+            client_output_flushed(srv, i);
+}
+
+static
+void replay_record(replay_t *rp, const journal_record_t *record,
+    const char *payload)
+{
+    if (record->timestamp > SERVER_CLOCK.now)
+        SERVER_CLOCK.now = record->timestamp;
+    switch (record->type) {
+        case JOURNAL_CONNECT:
+        case JOURNAL_DISCONNECT:
+            replay_client(rp, record);
+            break;
+        case JOURNAL_COMMAND:
+            replay_command(rp, record, payload);
+            break;
+        case JOURNAL_FIRE:
+            replay_fire(rp, record);
+            break;
+        default:
+            rp->divergences++;
+    }
+    rp->records++;
+    if (rp->records % REPLAY_DISCARD_PERIOD == 0)
+        discard_outputs(&rp->srv);
+}
+
+static
+uint64_t wall_clock(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, nullptr);
+    return (uint64_t)tv.tv_sec * MICROSEC_IN_SEC + tv.tv_usec;
+}
+
+static
+void replay_report(const replay_t *rp, uint64_t wall, uint64_t simulated)
+{
+    printf("replayed %lu records (%lu commands, %lu events fired) "
+        "in %.3f s, covering %.3f s of game; %lu divergences\n",
+        rp->records, rp->commands, rp->fired,
+        (double)wall / MICROSEC_IN_SEC, (double)simulated / MICROSEC_IN_SEC,
+        rp->divergences);
+}
+
+static
+bool replay_run(replay_t *rp, journal_reader_t *reader)
+{
+    params_t p;
+    journal_record_t record;
+    uint64_t started = wall_clock();
+
+    journal_reader_params(reader, &p);
+    SERVER_CLOCK = (server_clock_t){ true, reader->header.booted_at };
+    if (!server_start(&rp->srv, &p))
+        return false;
+    for (const char *payload = journal_reader_next(reader, &record);
+        payload != nullptr; payload = journal_reader_next(reader, &record))
+        replay_record(rp, &record, payload);
+    replay_report(rp, wall_clock() - started,
+        SERVER_CLOCK.now - reader->header.booted_at);
+    return true;
+}
+
+bool journal_replay(const char *path)
+{
+    journal_reader_t reader = { };
+    replay_t rp = { .srv = { .self_fd = -1, .is_running = true } };
+    bool ok;
+
+    if (!journal_reader_open(&reader, path))
+        return false;
+    ok = replay_run(&rp, &reader);
+    server_destroy(&rp.srv);
+    journal_reader_close(&reader);
+    return ok && rp.divergences == 0;
+}
@@ -0,0 +1,173 @@
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "server.h"
+
+#include "journal.h"
+
+/** The journal is a file mapping grown by doubling, so that appending a
+record is two memcpy and never a system call on the hot path. The file is
+trimmed to the bytes actually written when the server shuts down. **/
+
+static constexpr const size_t JOURNAL_CHUNK = 1 << 20;
+
+struct journal_s {
+    int fd;
+    char *map;
+    size_t size;
+    size_t capacity;
+};
+
+static
+bool journal_reserve(journal_t *journal, size_t needed)
+{
+    size_t capacity = journal->capacity;
+    char *map;
+
+    while (capacity < journal->size + needed)
+        capacity *= 2;
+    if (capacity == journal->capacity)
+        return true;
+    if (ftruncate(journal->fd, capacity) < 0)
+        return false;
+    map = mremap(journal->map, journal->capacity, capacity, MREMAP_MAYMOVE);
+    if (map == MAP_FAILED)
+        return false;
+    journal->map = map;
+    journal->capacity = capacity;
+    return true;
+}
+
+static
+void journal_append(journal_t *journal, const journal_record_t *record,
+    const void *payload)
+{
+    size_t size = sizeof *record + record->length;
+
+    if (!journal_reserve(journal, size)) {
+        perror("Journal append failed");
+        return;
+    }
+    memcpy(journal->map + journal->size, record, sizeof *record);
+    if (record->length != 0)
+        memcpy(journal->map + journal->size + sizeof *record,
+            payload, record->length);
+    journal->size += size;
+}
+
+static
+journal_t *journal_open(const char *path)
+{
+    journal_t *journal = calloc(1, sizeof *journal);
+
+    if (journal == nullptr)
+        return nullptr;
+    journal->fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (journal->fd < 0 || ftruncate(journal->fd, JOURNAL_CHUNK) < 0)
+        return journal_close(journal), nullptr;
+    journal->map = mmap(nullptr, JOURNAL_CHUNK, PROT_READ | PROT_WRITE,
+        MAP_SHARED, journal->fd, 0);
+    if (journal->map == MAP_FAILED) {
+        journal->map = nullptr;
+        return journal_close(journal), nullptr;
+    }
+    journal->capacity = JOURNAL_CHUNK;
+    return journal;
+}
+
+static
+bool journal_write_header(journal_t *journal, const params_t *p,
+    uint64_t created_at, uint64_t booted_at)
+{
+    journal_header_t header = { .version = JOURNAL_VERSION,
+        .frequency = p->frequency, .seed = p->seed,
+        .map_width = p->map_width, .map_height = p->map_height,
+        .team_capacity = p->team_capacity,
+        .team_count = p->registered_team_count,
+        .created_at = created_at, .booted_at = booted_at };
+    size_t len;
+
+    journal->size = sizeof header;
+    for (size_t i = 0; i < header.team_count; i++) {
+        len = strlen(p->teams[i]) + 1;
+        if (!journal_reserve(journal, len))
+            return false;
+        memcpy(journal->map + journal->size, p->teams[i], len);
+        journal->size += len;
+    }
+    header.names_size = journal->size - sizeof header;
+    memcpy(header.magic, JOURNAL_MAGIC, sizeof header.magic);
+    memcpy(journal->map, &header, sizeof header);
+    return true;
+}
+
+bool journal_start(server_t *srv, const params_t *p, uint64_t created_at)
+{
+    if (p->journal_path == nullptr)
+        return true;
+    srv->journal = journal_open(p->journal_path);
+    if (srv->journal == nullptr)
+        return perror("Can't open journal"), false;
+    if (!journal_write_header(srv->journal, p, created_at, srv->start_time))
+        return perror("Can't write journal header"), false;
+    return true;
+}
+
+void journal_close(journal_t *journal)
+{
+    if (journal == nullptr)
+        return;
+    if (journal->map != nullptr) {
+        munmap(journal->map, journal->capacity);
+        if (ftruncate(journal->fd, journal->size) < 0)
+            perror("Can't trim journal");
+    }
+    if (journal->fd >= 0)
+        close(journal->fd);
+    free(journal);
+}
+
+void journal_event(journal_t *journal, journal_type_t type,
+    uint32_t client_id, uint8_t opcode)
+{
+    journal_record_t record = {
+        .client_id = client_id, .type = type, .opcode = opcode };
+
+    if (journal == nullptr)
+        return;
+    record.timestamp = get_timestamp();
+    journal_append(journal, &record, nullptr);
+}
+
+void journal_command(journal_t *journal, uint32_t client_id,
+    const char *line, size_t len)
+{
+    journal_record_t record = {
+        .client_id = client_id, .length = len, .type = JOURNAL_COMMAND };
+
+    if (journal == nullptr)
+        return;
+    record.timestamp = get_timestamp();
+    journal_append(journal, &record, line);
+}
+
+bool journal_pin_clock(const journal_t *journal)
+{
+    if (journal == nullptr || SERVER_CLOCK.is_virtual)
+        return false;
+    SERVER_CLOCK.now = get_timestamp();
+    SERVER_CLOCK.is_virtual = true;
+    return true;
+}
+
+void journal_unpin_clock(bool pinned)
+{
+    if (pinned)
+        SERVER_CLOCK.is_virtual = false;
+}
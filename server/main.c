@@ -3,6 +3,7 @@
 #include <string.h>
 #include <sys/time.h>
 
+#include "host/host.h"
 #include "utils/common_macros.h"
 
 #include "server.h"
@@ -18,6 +19,42 @@ const char SERVER_USAGE[] = {
     "  -n, --names <team1> ...   Set team names\n"
     "  -c, --client-number <num> Set the number of clients per team\n"
     "  -f, --freq <frequency>    reciprocal of time unit (default: 100)\n"
+    "  -H, --out-high <KiB>      pause a client's commands past this much\n"
+    "                            unsent output (default: 1024)\n"
+    "  -L, --out-low <KiB>       resume them below it (default: high / 4)\n"
+    "  -S, --out-stall <sec>     disconnect a paused client that reads\n"
+    "                            nothing for longer (default: 10)\n"
+    "  -B, --backlog <num>       listen backlog (default: SOMAXCONN)\n"
+    "  -R, --reuseport           bind with SO_REUSEPORT so that sharded\n"
+    "                            servers can share the port\n"
+    "  -s, --seed <num>          seed the map generation, for reproducible\n"
+    "                            runs\n"
+    "  -V, --virtual-clock       skip ahead to the next event whenever every\n"
+    "                            player waits for a reply, instead of\n"
+    "                            following the wall clock\n"
+    "  -J, --journal <file>      record every connection, command and event\n"
+    "                            fired to a journal file\n"
+    "  -P, --replay <file>       replay a journal without opening any\n"
+    "                            socket, then print a summary and exit\n"
+    "  -W, --snapshot <file>     periodically save the world to a file, from\n"
+    "                            a forked process\n"
+    "  -I, --snapshot-interval <sec>\n"
+    "                            time between two snapshots (default: 60)\n"
+    "  -r, --restore <file>      boot from a snapshot instead of a new world,\n"
+    "                            which sets -x, -y, -n, -c and -f\n"
+    "  -G, --spectator <port>    serve GUIs from a forked process on this\n"
+    "                            port, fed with the state changes\n"
+    "  -U, --unix <path>         also accept clients on a Unix socket, for\n"
+    "                            the AIs running on the same host\n"
+    "  -M, --matches <num>       host that many independent matches, one\n"
+    "                            thread each; clients pick theirs by\n"
+    "                            answering <match>:<team>\n"
+    "  -T, --tune <spec>         schedule the loop thread after a comma\n"
+    "                            separated spec: cpu=<n>[-<m>] pins it\n"
+    "                            (each match on the next CPU of the range),\n"
+    "                            fifo=<1-99> runs it under SCHED_FIFO,\n"
+    "                            nice=<1-20> lowers its nice level, and\n"
+    "                            mlock locks and prefaults the memory\n"
 };
 
 static constexpr const int EXIT_TEK_FAILURE = 84;
@@ -54,6 +91,11 @@ int main(int argc, char *argv[])
         return EXIT_TEK_FAILURE;
     if (params.help)
         return printf("%s\n", SERVER_USAGE), EXIT_SUCCESS;
+    if (params.replay_path != nullptr)
+        return journal_replay(params.replay_path)
+            ? EXIT_SUCCESS : EXIT_TEK_FAILURE;
+    if (params.match_count != 0)
+        return host_run(&params) ? EXIT_SUCCESS : EXIT_TEK_FAILURE;
     if (!server_run(&params, get_timestamp()))
         return EXIT_TEK_FAILURE;
     return EXIT_SUCCESS;
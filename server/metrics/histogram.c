@@ -0,0 +1,65 @@
+#include "metrics.h"
+
+static constexpr const size_t SUB_BUCKET_BITS = 3;
+static constexpr const size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+static
+size_t bucket_of(uint64_t value)
+{
+    size_t exponent;
+    size_t idx;
+
+    if (value < SUB_BUCKETS)
+        return value;
+    exponent = 63 - __builtin_clzll(value);
+    idx = SUB_BUCKETS + ((exponent - SUB_BUCKET_BITS) * SUB_BUCKETS)
+        + ((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return (idx < HISTOGRAM_BUCKETS) ? idx : HISTOGRAM_BUCKETS - 1;
+}
+
+uint64_t histogram_bucket_upper(size_t idx)
+{
+    size_t shift;
+    size_t sub;
+
+    if (idx < SUB_BUCKETS)
+        return idx;
+    if (idx >= HISTOGRAM_BUCKETS - 1)
+        return UINT64_MAX;
+    shift = (idx - SUB_BUCKETS) / SUB_BUCKETS;
+    sub = (idx - SUB_BUCKETS) % SUB_BUCKETS;
+    return ((uint64_t)(SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+void histogram_record(histogram_t *hist, uint64_t value)
+{
+    hist->buckets[bucket_of(value)]++;
+    hist->count++;
+    hist->sum += value;
+    if (value > hist->max)
+        hist->max = value;
+}
+
+uint64_t histogram_count_le(const histogram_t *hist, uint64_t bound)
+{
+    uint64_t count = 0;
+
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS
+        && histogram_bucket_upper(i) <= bound; i++)
+        count += hist->buckets[i];
+    return count;
+}
+
+uint64_t histogram_quantile(const histogram_t *hist, double q)
+{
+    uint64_t rank = (uint64_t)(q * (double)hist->count);
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen > rank)
+            return (histogram_bucket_upper(i) < hist->max)
+                ? histogram_bucket_upper(i) : hist->max;
+    }
+    return hist->max;
+}
@@ -0,0 +1,19 @@
+#include <stdlib.h>
+
+#include "metrics.h"
+
+metrics_t *metrics_create(void)
+{
+    metrics_t *metrics = calloc(1, sizeof *metrics);
+
+    if (metrics != nullptr)
+        metrics->current_opcode = METRICS_OPCODE_HANDSHAKE;
+    return metrics;
+}
+
+void metrics_tick_overrun(metrics_t *metrics, uint64_t late_us)
+{
+    metrics->tick_overruns++;
+    if (late_us > metrics->tick_overrun_max)
+        metrics->tick_overrun_max = late_us;
+}
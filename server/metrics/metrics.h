@@ -0,0 +1,203 @@
+#ifndef METRICS_H_
+    #define METRICS_H_
+
+    #include <stddef.h>
+    #include <stdint.h>
+
+/**
+ * @brief Number of buckets of a latency histogram.
+ *
+ * Values below 8 get a bucket each, then every power of two is split into 8
+ * linear sub-buckets, up to 2^32 µs: the relative error stays under 12.5%.
+ */
+static constexpr const size_t HISTOGRAM_BUCKETS = 240;
+
+/**
+ * @brief Stages of a command's life, each with its own latency histogram.
+ *
+ */
+typedef enum {
+    STAGE_INTAKE, // From the poll wake-up to the event being scheduled
+    STAGE_FIRE, // From the event deadline to its handler being run
+    STAGE_FLUSH, // From the reply being queued to it being fully sent
+    STAGE_COUNT
+} metrics_stage_t;
+
+/**
+ * @brief Client classes used to split the traffic counters.
+ *
+ */
+typedef enum {
+    CLASS_UNASSIGNED,
+    CLASS_GRAPHIC,
+    CLASS_PLAYER,
+    CLASS_COUNT
+} metrics_class_t;
+
+/**
+ * @brief HDR-style log-linear histogram of microsecond values.
+ *
+ */
+typedef struct {
+    uint64_t buckets[HISTOGRAM_BUCKETS];
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+} histogram_t;
+
+/**
+ * @brief Number of opcodes tracked, the last one gathering every command
+ * that is not a known event name.
+ */
+static constexpr const size_t METRICS_OPCODE_COUNT = 27;
+/**
+ * @brief Opcode of the replies queued outside of any event handler
+ * (WELCOME, team assignment).
+ */
+static constexpr const size_t METRICS_OPCODE_HANDSHAKE = 25;
+static constexpr const size_t METRICS_OPCODE_OTHER = 26;
+
+/**
+ * @brief Server wide counters and histograms.
+ *
+ */
+typedef struct {
+    histogram_t latency[METRICS_OPCODE_COUNT][STAGE_COUNT];
+    uint64_t bytes_in[CLASS_COUNT];
+    uint64_t bytes_out[CLASS_COUNT];
+    uint64_t poll_wakeups;
+    uint64_t tick_overruns;
+    uint64_t tick_overrun_max; // in microseconds
+    histogram_t wakeup_late; // How late poll returned past its timeout
+    uint64_t intake_budget_hits; // Client rounds ending with lines left
+    uint64_t event_queue_max;
+    histogram_t snapshot_pause; // Main loop time spent forking the writer
+    histogram_t snapshot_duration; // From the fork to the writer exiting
+    uint64_t snapshot_failures;
+    uint64_t spectator_feed_bytes; // Records queued for the observer
+    uint64_t spectator_respawns; // Observers replaced after falling behind
+    uint8_t current_opcode; // Opcode of the handler being run
+} metrics_t;
+
+/**
+ * @brief Allocates zeroed metrics, outside of any handler.
+ *
+ * @return metrics_t* nullptr on allocation failure
+ */
+metrics_t *metrics_create(void);
+/**
+ * @brief Counts a main loop iteration that started past its deadline.
+ *
+ * @param metrics
+ * @param late_us How late the loop was, in microseconds.
+ */
+void metrics_tick_overrun(metrics_t *metrics, uint64_t late_us);
+
+/**
+ * @brief Adds a value to the histogram.
+ *
+ * @param hist
+ * @param value
+ */
+void histogram_record(histogram_t *hist, uint64_t value);
+/**
+ * @brief Highest value that lands in the given bucket.
+ *
+ * @param idx
+ * @return uint64_t
+ */
+uint64_t histogram_bucket_upper(size_t idx);
+/**
+ * @brief Number of recorded values that are lower or equal to the bound.
+ *
+ * @param hist
+ * @param bound
+ * @return uint64_t
+ */
+uint64_t histogram_count_le(const histogram_t *hist, uint64_t bound);
+/**
+ * @brief Upper bound of the bucket holding the given quantile, capped by the
+ * highest recorded value.
+ *
+ * @param hist
+ * @param q Between 0 and 1
+ * @return uint64_t
+ */
+uint64_t histogram_quantile(const histogram_t *hist, double q);
+
+/**
+ * @brief Maps a command (or internal event) name to its opcode.
+ *
+ * @param command
+ * @return size_t METRICS_OPCODE_OTHER for unknown names
+ */
+size_t metrics_opcode(const char *command);
+/**
+ * @brief Name of the given opcode.
+ *
+ * @param opcode
+ * @return const char*
+ */
+const char *metrics_opcode_name(size_t opcode);
+
+typedef struct server_s server_t;
+typedef struct client_state_s client_state_t;
+
+/**
+ * @brief Queues the metrics, in Prometheus text format, to the client.
+ *
+ * @param srv
+ * @param client
+ */
+void metrics_export(server_t *srv, client_state_t *client);
+
+/**
+ * @brief Queues the game side of the metrics, such as the players of each
+ * team and tier, to the client.
+ *
+ * @param srv
+ * @param client
+ */
+void metrics_export_game(server_t *srv, client_state_t *client);
+
+/**
+ * @brief Queues how the loop thread is scheduled and how late it wakes up
+ * to the client.
+ *
+ * @param srv
+ * @param client
+ */
+void metrics_export_sched(server_t *srv, client_state_t *client);
+/**
+ * @brief Queues the lines cut off by the intake budget to the client, along
+ * with the intake of the clients that outran it.
+ *
+ * @param srv
+ * @param client
+ */
+void metrics_export_intake(server_t *srv, client_state_t *client);
+/**
+ * @brief Queues how the GUIs were caught up and how much their compression
+ * saved and cost to the client.
+ *
+ * @param srv
+ * @param client
+ */
+void metrics_export_gui(server_t *srv, client_state_t *client);
+
+/**
+ * @brief Records the latency of a stage for an opcode.
+ *
+ * @param metrics
+ * @param opcode
+ * @param stage
+ * @param us
+ */
+static inline
+void metrics_record(metrics_t *metrics, size_t opcode,
+    metrics_stage_t stage, uint64_t us)
+{
+    histogram_record(&metrics->latency[opcode][stage], us);
+}
+
+#endif /* !METRICS_H_ */
@@ -0,0 +1,193 @@
+#include "client/client.h"
+#include "utils/buffer_pool.h"
+#include "utils/common_macros.h"
+
+#include "metrics.h"
+#include "server.h"
+
+/** Renders the metrics in the Prometheus text exposition format. **/
+
+static const uint64_t LATENCY_BOUNDS_US[] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+    100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000,
+};
+
+static const char *STAGE_NAMES[STAGE_COUNT] = { "intake", "fire", "flush" };
+
+static const char *CLASS_NAMES[CLASS_COUNT] = {
+    "unassigned", "graphic", "player"
+};
+
+static
+void export_histogram(server_t *srv, client_state_t *cl,
+    size_t opcode, metrics_stage_t stage)
+{
+    const histogram_t *hist = &srv->metrics->latency[opcode][stage];
+    const char *name = metrics_opcode_name(opcode);
+
+    for (size_t i = 0; i < LENGTH_OF(LATENCY_BOUNDS_US); i++)
+        vappend_to_output(srv, cl, "zappy_command_latency_seconds_bucket"
+            "{opcode=\"%s\",stage=\"%s\",le=\"%g\"} %lu\n",
+            name, STAGE_NAMES[stage], (double)LATENCY_BOUNDS_US[i] / 1e6,
+            histogram_count_le(hist, LATENCY_BOUNDS_US[i]));
+    vappend_to_output(srv, cl, "zappy_command_latency_seconds_bucket"
+        "{opcode=\"%s\",stage=\"%s\",le=\"+Inf\"} %lu\n"
+        "zappy_command_latency_seconds_sum"
+        "{opcode=\"%s\",stage=\"%s\"} %.6f\n"
+        "zappy_command_latency_seconds_count"
+        "{opcode=\"%s\",stage=\"%s\"} %lu\n",
+        name, STAGE_NAMES[stage], hist->count,
+        name, STAGE_NAMES[stage], (double)hist->sum / 1e6,
+        name, STAGE_NAMES[stage], hist->count);
+}
+
+static
+void export_latencies(server_t *srv, client_state_t *cl)
+{
+    append_to_output(srv, cl, "# HELP zappy_command_latency_seconds "
+        "Time spent by commands in each stage: intake (poll wake-up to "
+        "scheduling), fire (deadline to handler), flush (reply queued to "
+        "sent).\n# TYPE zappy_command_latency_seconds histogram\n");
+    for (size_t op = 0; op < METRICS_OPCODE_COUNT; op++)
+        for (size_t stage = 0; stage < STAGE_COUNT; stage++)
+            if (srv->metrics->latency[op][stage].count != 0)
+                export_histogram(srv, cl, op, stage);
+}
+
+static
+void export_traffic(server_t *srv, client_state_t *cl)
+{
+    append_to_output(srv, cl, "# TYPE zappy_client_bytes_total counter\n");
+    for (size_t c = 0; c < CLASS_COUNT; c++)
+        vappend_to_output(srv, cl,
+            "zappy_client_bytes_total{class=\"%s\",direction=\"in\"} %lu\n"
+            "zappy_client_bytes_total{class=\"%s\",direction=\"out\"} %lu\n",
+            CLASS_NAMES[c], srv->metrics->bytes_in[c],
+            CLASS_NAMES[c], srv->metrics->bytes_out[c]);
+}
+
+static
+void count_clients(server_t *srv, size_t count[static CLASS_COUNT],
+    size_t buffered[static CLASS_COUNT])
+{
+    client_state_t *client;
+
+    for (size_t i = 1; i < srv->cm.count; i++) {
+        client = srv->cm.clients + i;
+        count[client_metrics_class(client)]++;
+        buffered[client_metrics_class(client)] +=
+            client->output.nmemb - client->out_buff_idx;
+    }
+}
+
+static
+void export_clients(server_t *srv, client_state_t *cl)
+{
+    size_t count[CLASS_COUNT] = { };
+    size_t buffered[CLASS_COUNT] = { };
+
+    count_clients(srv, count, buffered);
+    append_to_output(srv, cl, "# TYPE zappy_clients gauge\n");
+    for (size_t c = 0; c < CLASS_COUNT; c++)
+        vappend_to_output(srv, cl, "zappy_clients{class=\"%s\"} %zu\n",
+            CLASS_NAMES[c], count[c]);
+    append_to_output(srv, cl,
+        "# TYPE zappy_client_buffered_output_bytes gauge\n");
+    for (size_t c = 0; c < CLASS_COUNT; c++)
+        vappend_to_output(srv, cl,
+            "zappy_client_buffered_output_bytes{class=\"%s\"} %zu\n",
+            CLASS_NAMES[c], buffered[c]);
+}
+
+static
+void export_loop(server_t *srv, client_state_t *cl)
+{
+    const metrics_t *m = srv->metrics;
+
+    vappend_to_output(srv, cl, "# TYPE zappy_poll_wakeups_total counter\n"
+        "zappy_poll_wakeups_total %lu\n"
+        "# TYPE zappy_tick_overruns_total counter\n"
+        "zappy_tick_overruns_total %lu\n"
+        "# TYPE zappy_tick_overrun_max_seconds gauge\n"
+        "zappy_tick_overrun_max_seconds %.6f\n"
+        "# TYPE zappy_event_queue_depth gauge\n"
+        "zappy_event_queue_depth{lane=\"gui\"} %zu\n"
+        "zappy_event_queue_depth{lane=\"action\"} %zu\n"
+        "zappy_event_queue_depth{lane=\"timer\"} %zu\n"
+        "# TYPE zappy_event_queue_depth_max gauge\n"
+        "zappy_event_queue_depth_max %lu\n",
+        m->poll_wakeups, m->tick_overruns,
+        (double)m->tick_overrun_max / 1e6,
+        srv->events.gui.nmemb - srv->events.gui.head,
+        srv->events.actions.nmemb, srv->events.timers.nmemb,
+        m->event_queue_max);
+}
+
+static
+void export_allocations(server_t *srv, client_state_t *cl)
+{
+    const buffer_pool_stats_t *pool = buffer_pool_stats();
+
+    vappend_to_output(srv, cl, "# TYPE zappy_accepted_total counter\n"
+        "zappy_accepted_total %lu\n"
+        "# TYPE zappy_accept_batches_total counter\n"
+        "zappy_accept_batches_total %lu\n"
+        "# TYPE zappy_buffer_pool_requests_total counter\n"
+        "zappy_buffer_pool_requests_total{result=\"hit\"} %lu\n"
+        "zappy_buffer_pool_requests_total{result=\"miss\"} %lu\n"
+        "# TYPE zappy_buffer_pool_resident_bytes gauge\n"
+        "zappy_buffer_pool_resident_bytes %zu\n",
+        srv->accept_stats.accepted, srv->accept_stats.batches,
+        pool->hits, pool->misses, pool->resident);
+}
+
+static
+void export_snapshots(server_t *srv, client_state_t *cl)
+{
+    const metrics_t *m = srv->metrics;
+
+    vappend_to_output(srv, cl, "# HELP zappy_snapshot_pause_seconds "
+        "Time the main loop spent forking a snapshot writer.\n"
+        "# TYPE zappy_snapshot_pause_seconds summary\n"
+        "zappy_snapshot_pause_seconds_sum %.6f\n"
+        "zappy_snapshot_pause_seconds_count %lu\n"
+        "# TYPE zappy_snapshot_pause_max_seconds gauge\n"
+        "zappy_snapshot_pause_max_seconds %.6f\n"
+        "# TYPE zappy_snapshot_duration_max_seconds gauge\n"
+        "zappy_snapshot_duration_max_seconds %.6f\n"
+        "# TYPE zappy_snapshots_total counter\n"
+        "zappy_snapshots_total{result=\"written\"} %lu\n"
+        "zappy_snapshots_total{result=\"failed\"} %lu\n",
+        (double)m->snapshot_pause.sum / 1e6, m->snapshot_pause.count,
+        (double)m->snapshot_pause.max / 1e6,
+        (double)m->snapshot_duration.max / 1e6,
+        m->snapshot_duration.count, m->snapshot_failures);
+}
+
+static
+void export_spectator(server_t *srv, client_state_t *cl)
+{
+    vappend_to_output(srv, cl, "# HELP zappy_spectator_feed_bytes_total "
+        "State changes queued for the GUI observer.\n"
+        "# TYPE zappy_spectator_feed_bytes_total counter\n"
+        "zappy_spectator_feed_bytes_total %lu\n"
+        "# TYPE zappy_spectator_respawns_total counter\n"
+        "zappy_spectator_respawns_total %lu\n",
+        srv->metrics->spectator_feed_bytes,
+        srv->metrics->spectator_respawns);
+}
+
+void metrics_export(server_t *srv, client_state_t *client)
+{
+    export_latencies(srv, client);
+    export_traffic(srv, client);
+    export_clients(srv, client);
+    export_loop(srv, client);
+    export_allocations(srv, client);
+    export_snapshots(srv, client);
+    export_spectator(srv, client);
+    metrics_export_game(srv, client);
+    metrics_export_sched(srv, client);
+    metrics_export_intake(srv, client);
+    metrics_export_gui(srv, client);
+}
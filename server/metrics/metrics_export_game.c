@@ -0,0 +1,39 @@
+#include "client/client.h"
+#include "game_events/map_resources.h"
+
+#include "metrics.h"
+#include "server.h"
+
+/** Renders the state of the game itself, read from the counters the
+simulation keeps up to date, so an export never scans the players. **/
+
+static
+void export_team_players(server_t *srv, client_state_t *cl, size_t team)
+{
+    for (size_t tier = 1; tier <= TIER_MAX; tier++)
+        vappend_to_output(srv, cl,
+            "zappy_team_players{team=\"%s\",tier=\"%zu\"} %hu\n",
+            srv->team_names[team], tier, srv->team_tiers[team][tier]);
+}
+
+static
+void export_map_resources(server_t *srv, client_state_t *cl)
+{
+    append_to_output(srv, cl, "# HELP zappy_map_resources "
+        "Resources lying on the map.\n"
+        "# TYPE zappy_map_resources gauge\n");
+    for (size_t i = 0; i < RES_COUNT; i++)
+        vappend_to_output(srv, cl,
+            "zappy_map_resources{resource=\"%s\"} %u\n", RESOURCE_NAMES[i],
+            srv->total_item_in_map.qnts[i]);
+}
+
+void metrics_export_game(server_t *srv, client_state_t *client)
+{
+    append_to_output(srv, client, "# HELP zappy_team_players "
+        "Players of each team, by tier.\n"
+        "# TYPE zappy_team_players gauge\n");
+    for (size_t j = TEAM_ID_GRAPHIC + 1; srv->team_names[j] != nullptr; j++)
+        export_team_players(srv, client, j);
+    export_map_resources(srv, client);
+}
@@ -0,0 +1,32 @@
+#include "client/client.h"
+
+#include "metrics.h"
+#include "server.h"
+
+/** Renders the GUI stream: how the sequenced GUIs were caught up, and what
+the compression of the compressed ones saved, out of the bytes it was fed,
+and cost, in CPU time. Shared messages are counted once, however many GUIs
+they were queued to. **/
+
+void metrics_export_gui(server_t *srv, client_state_t *client)
+{
+    const gui_stream_t *stream = &srv->gui_stream;
+
+    vappend_to_output(srv, client, "# HELP zappy_gui_stream_bytes_total "
+        "Messages recorded for the sequenced GUIs.\n"
+        "# TYPE zappy_gui_stream_bytes_total counter\n"
+        "zappy_gui_stream_bytes_total %lu\n"
+        "# TYPE zappy_gui_stream_joins_total counter\n"
+        "zappy_gui_stream_joins_total{from=\"stream\"} %lu\n"
+        "zappy_gui_stream_joins_total{from=\"snapshot\"} %lu\n"
+        "# HELP zappy_gui_deflate_bytes_total Bytes fed to and produced by "
+        "the compressor of the compressed GUIs.\n"
+        "# TYPE zappy_gui_deflate_bytes_total counter\n"
+        "zappy_gui_deflate_bytes_total{side=\"in\"} %lu\n"
+        "zappy_gui_deflate_bytes_total{side=\"out\"} %lu\n"
+        "# TYPE zappy_gui_deflate_seconds_total counter\n"
+        "zappy_gui_deflate_seconds_total %.6f\n",
+        stream->head, stream->resumes, stream->snapshots,
+        stream->deflate_in, stream->deflate_out,
+        (double)stream->deflate_time / 1e6);
+}
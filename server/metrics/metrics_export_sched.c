@@ -0,0 +1,77 @@
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "client/client.h"
+
+#include "metrics.h"
+#include "server.h"
+
+/** Renders how the loop thread is scheduled, read back from the system,
+and how late poll returns once its timeout expired: the time a ready thread
+waits for a CPU. Also renders how the intake shares the loop between the
+clients: only the clients that outran the line budget are listed, so a
+flooding bot shows without one series per connection. **/
+
+static
+const char *policy_name(int policy)
+{
+    switch (policy) {
+        case SCHED_FIFO:
+            return "fifo";
+        case SCHED_RR:
+            return "rr";
+        case SCHED_BATCH:
+            return "batch";
+        case SCHED_IDLE:
+            return "idle";
+        default:
+            return "other";
+    }
+}
+
+void metrics_export_intake(server_t *srv, client_state_t *client)
+{
+    const client_state_t *cl;
+
+    vappend_to_output(srv, client, "# HELP zappy_intake_budget_hits_total "
+        "Client rounds that ended with lines left over.\n"
+        "# TYPE zappy_intake_budget_hits_total counter\n"
+        "zappy_intake_budget_hits_total %lu\n"
+        "# HELP zappy_client_intake_lines_total Lines processed for the "
+        "clients that outran the budget.\n"
+        "# TYPE zappy_client_intake_lines_total counter\n",
+        srv->metrics->intake_budget_hits);
+    for (size_t i = 1; i < srv->cm.count; i++) {
+        cl = srv->cm.clients + i;
+        if (cl->intake_budget_hits != 0)
+            vappend_to_output(srv, client, "zappy_client_intake_lines_total"
+                "{id=\"%u\",team=\"%s\"} %lu\n", cl->id,
+                srv->team_names[cl->team_id], cl->intake_lines);
+    }
+}
+
+void metrics_export_sched(server_t *srv, client_state_t *client)
+{
+    const histogram_t *late = &srv->metrics->wakeup_late;
+    struct sched_param param = { };
+    int policy = SCHED_OTHER;
+
+    pthread_getschedparam(pthread_self(), &policy, &param);
+    vappend_to_output(srv, client, "# HELP zappy_wakeup_latency_seconds "
+        "Time poll returned past its timeout.\n"
+        "# TYPE zappy_wakeup_latency_seconds summary\n"
+        "zappy_wakeup_latency_seconds{quantile=\"0.5\"} %.6f\n"
+        "zappy_wakeup_latency_seconds{quantile=\"0.99\"} %.6f\n"
+        "zappy_wakeup_latency_seconds_sum %.6f\n"
+        "zappy_wakeup_latency_seconds_count %lu\n"
+        "# TYPE zappy_wakeup_latency_max_seconds gauge\n"
+        "zappy_wakeup_latency_max_seconds %.6f\n"
+        "# TYPE zappy_loop_scheduling gauge\n"
+        "zappy_loop_scheduling{policy=\"%s\",cpu=\"%d\"} %d\n",
+        (double)histogram_quantile(late, 0.5) / 1e6,
+        (double)histogram_quantile(late, 0.99) / 1e6,
+        (double)late->sum / 1e6, late->count, (double)late->max / 1e6,
+        policy_name(policy), sched_getcpu(), param.sched_priority);
+}
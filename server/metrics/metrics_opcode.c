@@ -0,0 +1,57 @@
+#include <assert.h>
+#include <string.h>
+
+#include "game_events/names.h"
+#include "utils/common_macros.h"
+
+#include "metrics.h"
+
+static const char *OPCODE_NAMES[] = {
+    METEOR,
+    PLAYER_DEATH,
+    PLAYER_INVENTORY,
+    PLAYER_BROADCAST,
+    PLAYER_LOOK,
+    PLAYER_LEFT,
+    PLAYER_RIGHT,
+    PLAYER_FORWARD,
+    PLAYER_EJECT,
+    PLAYER_TAKE_OBJECT,
+    PLAYER_SET_OBJECT,
+    PLAYER_FORK,
+    PLAYER_START_INCANTATION,
+    PLAYER_END_INCANTATION,
+    PLAYER_LOCK,
+    TEAM_AVAILABLE_SLOTS,
+    GUI_PLAYER_POS,
+    GUI_PLAYER_INV,
+    GUI_PLAYER_LVL,
+    GUI_TIME_GET,
+    GUI_TIME_SET,
+    GUI_MAP_SIZE,
+    GUI_MAP_CONTENT,
+    GUI_TILE_CONTENT,
+    GUI_TEAM_NAMES,
+    "handshake",
+    "other",
+};
+
+static_assert(LENGTH_OF(OPCODE_NAMES) == METRICS_OPCODE_COUNT,
+    "Every opcode needs a name");
+
+size_t metrics_opcode(const char *command)
+{
+    if (command == nullptr)
+        return METRICS_OPCODE_OTHER;
+    for (size_t i = 0; i < METRICS_OPCODE_HANDSHAKE; i++)
+        if (!strcmp(OPCODE_NAMES[i], command))
+            return i;
+    return METRICS_OPCODE_OTHER;
+}
+
+const char *metrics_opcode_name(size_t opcode)
+{
+    if (opcode >= METRICS_OPCODE_COUNT)
+        opcode = METRICS_OPCODE_OTHER;
+    return OPCODE_NAMES[opcode];
+}
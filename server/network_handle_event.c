@@ -1,15 +1,23 @@
+#include <errno.h>
 #include <poll.h>
 #include <stdio.h>
 
 #include "client/client.h"
+#include "host/host.h"
 #include "utils/debug.h"
 #include "server.h"
 
-void handle_poll(server_t *srv, uint64_t timeout)
+void handle_poll(server_t *srv, int timeout)
 {
+    uint64_t due = get_timestamp() + (uint64_t)timeout * MILISEC_IN_SEC;
     int poll_result = poll(srv->cm.server_pfds, srv->cm.count, timeout);
 
-    if (poll_result < 0) {
+    srv->poll_woke_at = get_timestamp();
+    srv->metrics->poll_wakeups++;
+    if (poll_result == 0 && timeout > 0)
+        histogram_record(&srv->metrics->wakeup_late,
+            srv->poll_woke_at > due ? srv->poll_woke_at - due : 0);
+    if (poll_result < 0 && errno != EINTR) {
         if (srv->is_running)
             perror("poll failed");
     }
@@ -17,7 +25,9 @@ void handle_poll(server_t *srv, uint64_t timeout)
 
 void handle_fds_revents(server_t *srv)
 {
-    if (srv->cm.server_pfds[0].revents & POLLIN)
+    if (srv->cm.server_pfds[0].revents & POLLIN && srv->is_hosted)
+        match_adopt_clients(srv);
+    else if (srv->cm.server_pfds[0].revents & POLLIN)
         add_client(srv);
     for (size_t i = 1; i < srv->cm.count; i++) {
         if (srv->cm.server_pfds[i].revents & POLLIN)
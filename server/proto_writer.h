@@ -0,0 +1,151 @@
+#ifndef PROTO_WRITER_H_
+    #define PROTO_WRITER_H_
+
+    #include <stdint.h>
+    #include <string.h>
+
+    #include "utils/common_macros.h"
+    #include "server.h"
+
+/** Typed writers for the replies sent most often. Each one writes at dst,
+which must have room for it, and returns the end of what it wrote, without
+a NUL byte; a reply is built by chaining them into the space reserved in an
+output buffer. Numbers are written two digits at a time, from a table of
+the pairs, instead of going through printf. **/
+
+extern const char PROTO_DIGIT_PAIRS[200];
+
+static constexpr const size_t PROTO_U32_MAX_LEN = 10;
+
+/**
+ * @brief Room taken by an inventory: a number and a separator per resource.
+ */
+static constexpr const size_t PROTO_INVENTORY_MAX_LEN =
+    RES_COUNT * (PROTO_U32_MAX_LEN + 1);
+
+/**
+ * @brief Room taken by a pin or a bct message, the longest of the ones
+ * below.
+ */
+static constexpr const size_t PROTO_TILE_MSG_MAX_LEN =
+    4 + 3 * (PROTO_U32_MAX_LEN + 2) + PROTO_INVENTORY_MAX_LEN;
+
+    #define PROTO_LIT(dst, lit) proto_str(dst, lit, SSTR_LEN(lit))
+
+static inline
+char *proto_str(char *dst, const char *str, size_t len)
+{
+    memcpy(dst, str, len);
+    return dst + len;
+}
+
+static inline
+char *proto_u32(char *dst, uint32_t value)
+{
+    size_t len = 1 + (value >= 10) + (value >= 100) + (value >= 1000)
+        + (value >= 10000) + (value >= 100000) + (value >= 1000000)
+        + (value >= 10000000) + (value >= 100000000)
+        + (value >= 1000000000);
+    char *end = dst + len;
+
+    for (; value >= 100; value /= 100) {
+        len -= 2;
+        memcpy(dst + len, PROTO_DIGIT_PAIRS + value % 100 * 2, 2);
+    }
+    if (value >= 10)
+        memcpy(dst, PROTO_DIGIT_PAIRS + value * 2, 2);
+    else
+        *dst = '0' + value;
+    return end;
+}
+
+/**
+ * @brief Writes a client id the way the GUI protocol does, after a '#'.
+ */
+static inline
+char *proto_id(char *dst, uint32_t id)
+{
+    *dst = '#';
+    return proto_u32(dst + 1, id);
+}
+
+/**
+ * @brief Writes the quantities of an inventory, separated by spaces.
+ */
+static inline
+char *proto_inventory(char *dst, const inventory_t *inv)
+{
+    dst = proto_u32(dst, inv->qnts[0]);
+    for (size_t i = 1; i < RES_COUNT; i++) {
+        *dst = ' ';
+        dst = proto_u32(dst + 1, inv->qnts[i]);
+    }
+    return dst;
+}
+
+/**
+ * @brief Writes "<x> <y>", the position of a tile.
+ */
+static inline
+char *proto_pos(char *dst, uint32_t x, uint32_t y)
+{
+    dst = proto_u32(dst, x);
+    *dst = ' ';
+    return proto_u32(dst + 1, y);
+}
+
+/**
+ * @brief Writes a ppo message, orientation being the one of orientation_t.
+ */
+static inline
+char *proto_ppo(char *dst, uint32_t id, const uint8_t pos[2],
+    uint8_t orientation)
+{
+    dst = proto_id(PROTO_LIT(dst, "ppo "), id);
+    *dst = ' ';
+    dst = proto_pos(dst + 1, pos[0], pos[1]);
+    *dst = ' ';
+    return PROTO_LIT(proto_u32(dst + 1, orientation + 1), "\n");
+}
+
+static inline
+char *proto_plv(char *dst, uint32_t id, uint8_t tier)
+{
+    dst = proto_id(PROTO_LIT(dst, "plv "), id);
+    *dst = ' ';
+    return PROTO_LIT(proto_u32(dst + 1, tier), "\n");
+}
+
+static inline
+char *proto_pin(char *dst, uint32_t id, const uint8_t pos[2],
+    const inventory_t *inv)
+{
+    dst = proto_id(PROTO_LIT(dst, "pin "), id);
+    *dst = ' ';
+    dst = proto_pos(dst + 1, pos[0], pos[1]);
+    *dst = ' ';
+    return PROTO_LIT(proto_inventory(dst + 1, inv), "\n");
+}
+
+static inline
+char *proto_bct(char *dst, uint32_t x, uint32_t y, const inventory_t *tile)
+{
+    dst = proto_pos(PROTO_LIT(dst, "bct "), x, y);
+    *dst = ' ';
+    return PROTO_LIT(proto_inventory(dst + 1, tile), "\n");
+}
+
+/**
+ * @brief Writes the bct message of every tile, which takes up to
+ * PROTO_TILE_MSG_MAX_LEN bytes a tile.
+ */
+static inline
+char *proto_map_content(char *dst, const server_t *srv)
+{
+    for (size_t y = 0; y < srv->map_height; y++)
+        for (size_t x = 0; x < srv->map_width; x++)
+            dst = proto_bct(dst, x, y, &srv->map[y][x]);
+    return dst;
+}
+
+#endif /* !PROTO_WRITER_H_ */
@@ -5,11 +5,16 @@
     #include <stdbool.h>
     #include <stddef.h>
     #include <stdint.h>
+    #include <stdio.h>
     #include <sys/time.h>
 
     #include "server_args_parser.h"
     #include "client/client_manager.h"
+    #include "journal/journal.h"
+    #include "metrics/metrics.h"
+    #include "snapshot/snapshot.h"
     #include "utils/debug.h"
+    #include "utils/resizable_array.h"
 
     #include "event.h"
 
@@ -30,6 +35,17 @@ enum {
     RES_COUNT
 };
 
+/**
+ * @brief Lanes of an inventory: the resources, padded with an always empty
+ * lane so that an inventory is two 128-bit vectors.
+ */
+static constexpr const size_t RES_LANES = 8;
+
+/**
+ * @brief Highest tier a player can reach.
+ */
+static constexpr const size_t TIER_MAX = 8;
+
 /**
  * @brief Maximum number of teams allowed in the server.
  *
@@ -47,6 +63,7 @@ typedef union {
         uint32_t thystame;
     };
     uint32_t qnts[RES_COUNT];
+    uint32_t lanes[RES_LANES];
 } inventory_t;
 
 /**
@@ -99,13 +116,88 @@ typedef struct {
     size_t capacity;
 } pollfd_array_t;
 
+/**
+ * @brief Bounds on the output a client may leave unread.
+ *
+ * Past high_water, the server stops reading the client's commands until its
+ * backlog drains under low_water; staying paused for longer than
+ * stall_timeout gets it disconnected.
+ */
+typedef struct {
+    size_t high_water;
+    size_t low_water;
+    uint64_t stall_timeout; // in microseconds
+} output_limits_t;
+
+/**
+ * @brief Counters on how fast pending connections get accepted.
+ *
+ * The wait is measured from the poll wake-up that reported the listening
+ * socket as readable to the accept of each connection of the batch.
+ */
+typedef struct {
+    uint64_t accepted;
+    uint64_t batches;
+    uint64_t batch_max;
+    uint64_t wait_total; // in microseconds
+    uint64_t wait_max; // in microseconds
+} accept_stats_t;
+
+/**
+ * @brief Time units a food ration lasts.
+ */
+static constexpr const size_t FOOD_PERIOD = 126;
+
+/**
+ * @brief Players eat on the ticks of their phase, ticks being the time units
+ * of the game time, and phases the tick following their arrival modulo
+ * FOOD_PERIOD. A single sweep per tick feeds every player of the phase, so
+ * one timer event is queued at a time.
+ */
+typedef struct {
+    uint32_t bucket[FOOD_PERIOD]; // Players per phase
+    uint64_t tick; // Last tick swept
+    uint64_t due_tick; // Tick of the armed sweep; other sweeps are stale
+    bool armed;
+} food_wheel_t;
+
+/**
+ * @brief Size of the GUI stream ring, power of two.
+ */
+static constexpr const size_t GUI_STREAM_SIZE = 1 << 20;
+
+/**
+ * @brief The messages sent to every GUI, kept in a ring so that a GUI coming
+ * back after a disconnection gets what it missed instead of a snapshot.
+ * Sequence numbers are the bytes ever recorded. Nothing is allocated nor
+ * recorded until a GUI asks for sequence numbers.
+ */
+typedef struct {
+    char *data;
+    uint64_t head; // Bytes ever recorded
+    uint64_t marked; // Head given to the sequenced GUIs last
+    uint64_t resumes; // GUIs that resumed from the ring
+    uint64_t snapshots; // Sequenced GUIs sent a snapshot instead
+    struct z_stream_s *deflate; // Set once a GUI asked for compression
+    resizable_array_t deflated; // Last segment compressed
+    uint64_t deflated_head; // Head compressed for the compressed GUIs
+    uint64_t deflate_in; // Bytes compressed, shared ones counted once
+    uint64_t deflate_out;
+    uint64_t deflate_time; // in microseconds
+} gui_stream_t;
+
+typedef struct spectator_s spectator_t;
+
 /**
  * @brief Structure representing the server state.
  *
  */
 typedef struct server_s {
     int self_fd;
+    int unix_fd; // Only open when unix_path is set
+    const char *unix_path;
     volatile bool is_running;
+    volatile bool stats_requested;
     egg_array_t eggs;
     client_manager_t cm;
     char *team_names[TEAM_COUNT_LIMIT];
@@ -113,9 +205,31 @@ typedef struct server_s {
     uint8_t map_width;
     inventory_t total_item_in_map;
     inventory_t map[MAP_MAX_SIDE_SIZE][MAP_MAX_SIDE_SIZE];
-    event_heap_t events;
+    // Players per tile and tier, kept up to date by tile_players_add
+    uint16_t tile_players[MAP_MAX_SIDE_SIZE][MAP_MAX_SIDE_SIZE][TIER_MAX + 1];
+    // Players per team and tier, kept up to date by player_census_add
+    uint16_t team_tiers[TEAM_COUNT_LIMIT][TIER_MAX + 1];
+    event_queue_t events;
+    food_wheel_t food;
+    output_limits_t out_limits;
+    accept_stats_t accept_stats;
+    metrics_t *metrics;
+    journal_t *journal;
+    snapshot_schedule_t snapshot;
+    gui_stream_t gui_stream;
+    spectator_t *spectator; // Set when the GUIs are served by an observer
+    bool is_observer; // Set in the observer, which only serves GUIs
+    bool is_hosted; // Set in a match of a hosting server, fed by its lobby
+    uint64_t poll_woke_at;
+    uint64_t intake_round; // Rounds run, which rotate the first client served
+    bool intake_backlog; // Lines are left for the next round, poll must not
+                         // wait
     uint64_t start_time;
+    uint64_t epoch_wall; // Wall time of the last change of frequency
+    uint64_t epoch_game; // Game time at that moment, see game_time_at
+    uint32_t next_client_id;
     uint16_t frequency; // reciprocal of time unit
+    uint8_t team_capacity;
     uint8_t last_egg_id;
 } server_t;
 
@@ -129,18 +243,128 @@ typedef struct server_s {
  */
 bool server_run(params_t *p, uint64_t timestamp);
 /**
- * @brief Initializes the server state.
+ * @brief Opens a non-blocking TCP socket listening on every interface.
+ *
+ * @param port
+ * @param reuseport Bind with SO_REUSEPORT
+ * @param backlog
+ * @return int The socket, or -1 with errno set.
+ */
+int server_socket_listen(uint16_t port, bool reuseport, int backlog);
+/**
+ * @brief Opens a non-blocking Unix-domain socket listening on a path. A
+ * socket file left there by a previous server is replaced.
+ *
+ * @param path
+ * @param backlog
+ * @return int The socket, or -1 with errno set.
+ */
+int server_socket_listen_unix(const char *path, int backlog);
+/**
+ * @brief Gathers two descriptors in an epoll set, so that a single pollfd
+ * wakes up for either of them.
+ *
+ * @param first
+ * @param second
+ * @return int The epoll descriptor, or -1 with errno set.
+ */
+int server_socket_watch(int first, int second);
+/**
+ * @brief Closes the game port and, if open, the Unix socket along with the
+ * epoll set watching both. The socket file is left to the caller.
+ *
+ * @param srv
+ */
+void server_close_listeners(server_t *srv);
+/**
+ * @brief Allocates the server state and builds the world, without opening
+ * any socket. The game time starts at 0, when the starting eggs hatch.
+ *
+ * @param srv
+ * @param p
+ * @return false if an allocation failed
+ */
+bool server_start(server_t *srv, params_t *p);
+/**
+ * @brief Removes every client and releases the server state.
+ *
+ * @param srv
+ */
+void server_destroy(server_t *srv);
+/**
+ * @brief Runs the main loop until the server is asked to stop.
+ *
+ * @param srv
+ */
+void server_loop(server_t *srv);
+/**
+ * @brief Registers the server the signals are reported to, then installs
+ * the handlers.
+ *
+ * @param srv
+ * @return false if sigaction failed
+ */
+bool install_signal_handlers(server_t *srv);
+
+/**
+ * @brief How the loop thread asks to be scheduled, parsed from -T.
+ */
+typedef struct {
+    int cpu_first; // -1 to leave the thread unpinned
+    int cpu_last;
+    int fifo_priority; // 0 to keep the default policy
+    int nice_boost; // How far the nice level is lowered
+    bool mlock; // Lock the memory and prefault the buffer pool
+} loop_tuning_t;
+
+/**
+ * @brief Parses a -T spec.
+ *
+ * @param spec
+ * @param tuning
+ * @return false if the spec is invalid, printing why on stderr
+ */
+bool loop_tuning_parse(const char *spec, loop_tuning_t *tuning);
+/**
+ * @brief Applies the -T spec to the calling thread, pinned to the nth CPU of
+ * the range. What the system refuses is only reported, the loop then runs
+ * as it would have without it.
+ *
+ * @param p
+ * @param nth Index of the match, 0 for a single one
+ * @return false if the spec is invalid
+ */
+bool server_tune_loop(const params_t *p, size_t nth);
+/**
+ * @brief Runs the events that are due, then flushes their replies.
  *
  * @param srv
  */
 void server_handle_events(server_t *srv);
+/**
+ * @brief Drops the events of removed clients that are due, then peeks at
+ * the next one.
+ *
+ * @param srv
+ * @param now
+ * @return const event_t* The next event if it is due, nullptr otherwise.
+ */
+const event_t *server_next_due_event(server_t *srv, uint64_t now);
+/**
+ * @brief Runs the next event if it is due and removes it from the queue.
+ *
+ * @param srv
+ * @param now
+ * @return true if an event was run
+ */
+bool server_fire_next_event(server_t *srv, uint64_t now);
 /**
  * @brief Initializes the server state.
  *
  * @param srv
  * @param timeout
  */
-void handle_poll(server_t *srv, uint64_t timeout);
+void handle_poll(server_t *srv, int timeout);
 /**
  * @brief Processes file descriptors and client buffers in the server.
  *
@@ -149,7 +373,59 @@ void handle_poll(server_t *srv, uint64_t timeout);
 void handle_fds_revents(server_t *srv);
 void handle_client_disconnection(server_t *srv);
 /**
- * @brief Processes the clients' input buffers in the server.
+ * @brief Disconnects the clients paused on output for too long.
+ *
+ * @param srv
+ */
+void disconnect_stalled_clients(server_t *srv);
+/**
+ * @brief Sends right away the output queued since the last flush, leaving
+ * POLLOUT to the sockets that could not take all of it.
+ *
+ * @param srv
+ */
+void flush_dirty_clients(server_t *srv);
+/**
+ * @brief Writes a per-client report of the buffered bytes.
+ *
+ * @param srv
+ * @param stream
+ */
+void server_dump_stats(server_t *srv, FILE *stream);
+/**
+ * @brief Waits for the sockets at most timeout ms (-1 for no limit), then
+ * handles their I/O and the commands received.
+ *
+ * @param srv
+ * @param timeout
+ */
+void server_poll_round(server_t *srv, int32_t timeout);
+/**
+ * @brief Waits until the next event is due, handling the I/O meanwhile.
+ *
+ * @param srv
+ */
+void server_wall_clock_step(server_t *srv);
+/**
+ * @brief Handles the pending I/O, then jumps to the next event if every
+ * player is waiting for a reply; blocks on the sockets otherwise.
+ *
+ * @param srv
+ */
+void server_virtual_clock_step(server_t *srv);
+/**
+ * @brief Changes the frequency from now on. The deadlines being kept in game
+ * time, the pending events, eggs and meals all follow the new pace.
+ *
+ * @param srv
+ * @param frequency 0 pauses the game
+ */
+void server_set_frequency(server_t *srv, uint16_t frequency);
+/**
+ * @brief Runs an intake round: each client gets up to INTAKE_LINE_BUDGET of
+ * its buffered lines processed, starting from a client that rotates from one
+ * round to the next. Sets intake_backlog when some are left for the next
+ * round.
  *
  * @param srv
  */
@@ -166,6 +442,18 @@ static constexpr const int MICROSEC_IN_SEC = 1000000;
  */
 static constexpr const int MILISEC_IN_SEC = 1000;
 
+/**
+ * @brief Clock every timestamp is read from. A virtual clock only moves when
+ * the main loop jumps to the next event. Each thread has its own, so the
+ * matches of a hosting server keep their own time.
+ */
+typedef struct {
+    bool is_virtual;
+    uint64_t now; // Virtual time, in microseconds
+} server_clock_t;
+
+extern thread_local server_clock_t SERVER_CLOCK;
+
 /**
  * @brief Get the timestamp object
  *
@@ -175,25 +463,73 @@ static inline uint64_t get_timestamp(void)
 {
     struct timeval tv;
 
+    if (UNLIKELY(SERVER_CLOCK.is_virtual))
+        return SERVER_CLOCK.now;
     gettimeofday(&tv, NULL);
     return (uint64_t)((tv.tv_sec * MICROSEC_IN_SEC) + tv.tv_usec);
 }
 
+/**
+ * @brief Game time in a time unit. Every deadline is kept in game time,
+ * which runs at the pace of the frequency since the last change of it: this
+ * is where it is converted from and to the wall time.
+ */
+static constexpr const uint64_t GAME_TIME_UNIT = MICROSEC_IN_SEC;
+
+/**
+ * @brief Converts a wall time, in microseconds, to game time. The game time
+ * never goes back, even if the wall clock does.
+ */
+static inline
+uint64_t game_time_at(const server_t *srv, uint64_t wall)
+{
+    if (wall <= srv->epoch_wall)
+        return srv->epoch_game;
+    return srv->epoch_game + (wall - srv->epoch_wall) * srv->frequency;
+}
+
+static inline
+uint64_t game_now(const server_t *srv)
+{
+    return game_time_at(srv, get_timestamp());
+}
+
+/**
+ * @brief Converts a game time to the wall time it is reached at, rounded up
+ * so that it is reached by then. Game times before the last change of
+ * frequency map to that change; none is reached while the game is paused.
+ */
+static inline
+uint64_t wall_time_of(const server_t *srv, uint64_t game)
+{
+    if (game <= srv->epoch_game)
+        return srv->epoch_wall;
+    if (srv->frequency == 0)
+        return UINT64_MAX;
+    return srv->epoch_wall
+        + (game - srv->epoch_game + srv->frequency - 1) / srv->frequency;
+}
+
 /**
  * @brief Computes the timeout for the next event in the server.
  *
  * @param srv
- * @return int32_t
+ * @return int32_t INT32_MAX when the next event is out of reach, e.g.
+ * while the game is paused.
  */
 static inline int32_t compute_timeout(server_t *srv)
 {
-    int64_t current_time = get_timestamp();
-    int64_t next_event_time = event_heap_peek(&srv->events)->timestamp;
-    int32_t diff = (next_event_time - current_time);
-    int32_t ms = diff / MILISEC_IN_SEC;
+    event_lane_t lane;
+    uint64_t next_event_time = wall_time_of(srv,
+        event_queue_peek(&srv->events, &lane)->timestamp);
+    int64_t diff = (int64_t)(next_event_time - get_timestamp());
+    int32_t ms;
 
+    if (next_event_time == UINT64_MAX || diff / MILISEC_IN_SEC > INT32_MAX)
+        return INT32_MAX;
+    ms = diff / MILISEC_IN_SEC;
     if (ms > 0) {
-        DEBUG("Timeout for next event: %u ms; diff µs: %d",
+        DEBUG("Timeout for next event: %u ms; diff µs: %ld",
             ms, diff - (MILISEC_IN_SEC * ms));
     }
     return ms;
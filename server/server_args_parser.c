@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
 
 #include "bits/getopt_core.h"
 #include "client/client.h"
@@ -16,6 +17,9 @@ static constexpr const char INVALID_ARG[] = {
     "Invalid option or missing argument\n%s\n"
 };
 
+static constexpr const char SHORT_OPTIONS[] = "hp:x:y:n:c:f:H:L:S:B:Rs:VJ:P:"
+    "W:I:r:G:U:M:T:";
+
 // Structure to hold the command line parameters, to be used by getopt_long
 static const struct option long_options[] = {
     {"help", no_argument, nullptr, 'h'},
@@ -25,14 +29,72 @@ static const struct option long_options[] = {
     {"names", required_argument, nullptr, 'n'},
     {"client-number", required_argument, nullptr, 'c'},
     {"freq", required_argument, nullptr, 'f'},
+    {"out-high", required_argument, nullptr, 'H'},
+    {"out-low", required_argument, nullptr, 'L'},
+    {"out-stall", required_argument, nullptr, 'S'},
+    {"backlog", required_argument, nullptr, 'B'},
+    {"reuseport", no_argument, nullptr, 'R'},
+    {"seed", required_argument, nullptr, 's'},
+    {"virtual-clock", no_argument, nullptr, 'V'},
+    {"journal", required_argument, nullptr, 'J'},
+    {"replay", required_argument, nullptr, 'P'},
+    {"snapshot", required_argument, nullptr, 'W'},
+    {"snapshot-interval", required_argument, nullptr, 'I'},
+    {"restore", required_argument, nullptr, 'r'},
+    {"spectator", required_argument, nullptr, 'G'},
+    {"unix", required_argument, nullptr, 'U'},
+    {"matches", required_argument, nullptr, 'M'},
+    {"tune", required_argument, nullptr, 'T'},
     {nullptr, 0, nullptr, 0}
 };
 
+/**
+ * @brief Range and destination of a tuning option.
+ */
+struct tuning_option_s {
+    char opt;
+    uint16_t min;
+    uint16_t max;
+    size_t offset; // Offset of the uint16_t field in params_t
+};
+
+static const struct tuning_option_s TUNING_OPTIONS[] = {
+    {'H', 1, 65535, offsetof(params_t, out_high_kib)},
+    {'L', 1, 65535, offsetof(params_t, out_low_kib)},
+    {'S', 1, 3600, offsetof(params_t, out_stall_sec)},
+    {'B', 1, 65535, offsetof(params_t, backlog)},
+    {'s', 1, 65535, offsetof(params_t, seed)},
+    {'I', 1, 65535, offsetof(params_t, snapshot_interval)},
+    {'G', 1024, 65535, offsetof(params_t, spectator_port)},
+    {'M', 1, 256, offsetof(params_t, match_count)},
+    {'\0', 0, 0, 0}
+};
+
+/**
+ * @brief Destination of an option kept as the string given.
+ */
+struct path_option_s {
+    char opt;
+    size_t offset; // Offset of the const char * field in params_t
+};
+
+static const struct path_option_s PATH_OPTIONS[] = {
+    {'J', offsetof(params_t, journal_path)},
+    {'P', offsetof(params_t, replay_path)},
+    {'W', offsetof(params_t, snapshot_path)},
+    {'r', offsetof(params_t, restore_path)},
+    {'U', offsetof(params_t, unix_path)},
+    {'T', offsetof(params_t, loop_tuning)},
+    {'\0', 0}
+};
+
 static
 size_t get_team_slot(char **teams, const char *team_name, size_t count)
 {
     size_t i = 0;
 
+    if (strcmp(team_name, METRICS_HANDSHAKE) == 0)
+        return TEAM_ID_SERVER;
     for (; i < count; i++)
         if (strcmp(teams[i], team_name) == 0)
             return i;
@@ -106,6 +168,50 @@ uint16_t parse_number_arg(
     return value;
 }
 
+/**
+ * @brief Dispatches the parsing of the options taking a path or a spec.
+ * @param params pointer to the params_t structure to fill
+ * @param arg the argument string to parse
+ * @param opt the option char that indicates which argument is being parsed
+ * @return true if it's a valid path option
+ * @return false otherwise, printing an error message to stderr
+ */
+static
+bool path_arg_dispatcher(params_t *params, const char *arg, char opt)
+{
+    const struct path_option_s *option = PATH_OPTIONS;
+
+    for (; option->opt != '\0' && option->opt != opt; option++);
+    if (option->opt == '\0')
+        return fprintf(stderr, INVALID_ARG, SERVER_USAGE), false;
+    *(const char **)(void *)((char *)params + option->offset) = arg;
+    return true;
+}
+
+/**
+ * @brief Dispatches the parsing of the tuning options, all of them numbers
+ * stored in a uint16_t field of the params.
+ * @param params pointer to the params_t structure to fill
+ * @param arg the argument string to parse
+ * @param opt the option char that indicates which argument is being parsed
+ * @return true if it's a valid numerical argument and parsed successfully
+ * @return false otherwise, printing an error message to stderr
+ */
+static
+bool tuning_arg_dispatcher(params_t *params, const char *arg, char opt)
+{
+    const struct tuning_option_s *option = TUNING_OPTIONS;
+    uint16_t *field;
+
+    for (; option->opt != '\0' && option->opt != opt; option++);
+    if (option->opt == '\0')
+        return path_arg_dispatcher(params, arg, opt);
+    field = (uint16_t *)(void *)((char *)params + option->offset);
+    *field = parse_number_arg(arg, (char []){ opt, '\0' },
+        option->min, option->max);
+    return *field != 0;
+}
+
 /**
  * @brief Dispatches the argument parsing based on the option character.
  * @param params pointer to the params_t structure to fill
@@ -134,7 +240,7 @@ bool number_arg_dispatcher(params_t *params, const char *arg, char opt)
             params->team_capacity = parse_number_arg(arg, "c", 1, 200);
             break;
         default:
-            return fprintf(stderr, INVALID_ARG, SERVER_USAGE), false;
+            return tuning_arg_dispatcher(params, arg, opt);
     }
     return true;
 }
@@ -154,13 +260,18 @@ bool arg_dispatcher(params_t *params, char *argv[], char opt)
         case 'h':
             params->help = true;
             return true;
+        case 'R':
+            params->reuseport = true;
+            return true;
+        case 'V':
+            params->virtual_clock = true;
+            return true;
         case 'n':
             optind--;
-            if (!parse_teams(params, argv, &optind)) {
-                fprintf(stderr, "Failed to parse team names.\n");
-                return false;
-            }
-            return true;
+            if (parse_teams(params, argv, &optind))
+                return true;
+            fprintf(stderr, "Failed to parse team names.\n");
+            return false;
         case '?':
         default:
             return number_arg_dispatcher(params, optarg, opt);
@@ -181,16 +292,50 @@ void print_params(const params_t *params)
     DEBUG("heigth = %d", params->map_height);
     DEBUG("clients_nb = %d", params->team_capacity);
     DEBUG("freq = %d", params->frequency);
+    DEBUG("backlog = %d%s", params->backlog,
+        params->reuseport ? ", SO_REUSEPORT" : "");
+    DEBUG("seed = %d%s", params->seed,
+        params->virtual_clock ? ", virtual clock" : "");
+    DEBUG("output water marks = %d/%d KiB, stall = %ds",
+        params->out_low_kib, params->out_high_kib, params->out_stall_sec);
     DEBUG_MSG("Teams:");
     for (size_t i = 0; params->teams[i] != nullptr; i++)
         DEBUG("  - %s: id = [%03zu]", params->teams[i], i);
     DEBUG_MSG("==================================================");
 }
 
+/**
+ * @brief Fills the networking options left unset and checks the order of
+ * the output water marks.
+ *
+ * @param params Params structure containing the parsed command line arguments.
+ * @return false if the low-water mark is not below the high-water mark
+ */
+static
+bool set_tuning_defaults(params_t *params)
+{
+    if (params->backlog == 0)
+        params->backlog = SOMAXCONN;
+    if (params->out_high_kib == 0)
+        params->out_high_kib = 1024;
+    if (params->out_low_kib == 0)
+        params->out_low_kib = params->out_high_kib / 4;
+    if (params->out_stall_sec == 0)
+        params->out_stall_sec = 10;
+    if (params->snapshot_interval == 0)
+        params->snapshot_interval = 60;
+    if (params->out_low_kib < params->out_high_kib)
+        return true;
+    fprintf(stderr, "Output low-water mark (%u KiB) must be below "
+        "the high-water mark (%u KiB)\n",
+        params->out_low_kib, params->out_high_kib);
+    return false;
+}
+
 bool parse_args(params_t *params, int argc, char *argv[])
 {
     for (int opt;;) {
-        opt = getopt_long(argc, argv, "hp:x:y:n:c:f:", long_options, nullptr);
+        opt = getopt_long(argc, argv, SHORT_OPTIONS, long_options, nullptr);
         if (opt < 0)
             break;
         if (!arg_dispatcher(params, argv, opt))
@@ -198,11 +343,13 @@ bool parse_args(params_t *params, int argc, char *argv[])
     }
     if (params->frequency == 0)
         params->frequency = 100;
-    if (params->port == 0
-        || params->map_width == 0
+    if (!set_tuning_defaults(params))
+        return false;
+    if (params->replay_path == nullptr && (params->port == 0
+        || (params->restore_path == nullptr && (params->map_width == 0
         || params->map_height == 0
         || params->team_capacity == 0
-        || params->teams == nullptr
+        || params->teams == nullptr)))
     )
         return fprintf(stderr, "%s", SERVER_USAGE), false;
     DEBUG_CALL(print_params, params);
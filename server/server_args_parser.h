@@ -8,6 +8,8 @@
 
     // Maximum number of teams allowed including GRAPHIC
     #define TEAM_COUNT_LIMIT 1 << (CHAR_BIT * sizeof (char))
+    // Handshake word asking for a metrics dump, so it cannot name a team
+    #define METRICS_HANDSHAKE "METRICS"
 
 /**
  * @brief Structure to hold command line parameters for the server.
@@ -20,6 +22,22 @@ typedef struct params_s {
     uint8_t map_height; // Range between 10 and 42
     uint16_t port; // Range between 1024 and 65535
     uint8_t team_capacity; // Range between 1 and 200
+    uint16_t out_high_kib; // Output high-water mark, in KiB
+    uint16_t out_low_kib; // Output low-water mark, in KiB
+    uint16_t out_stall_sec; // Time a paused client may read nothing
+    uint16_t backlog; // Listen backlog, range between 1 and 65535
+    uint16_t seed; // Seed of the map generation, 0 to leave it unseeded
+    const char *journal_path; // File to journal the session to, if any
+    const char *replay_path; // Journal to replay instead of serving
+    const char *snapshot_path; // File to snapshot the world to, if any
+    const char *restore_path; // Snapshot to boot from instead of a new world
+    const char *unix_path; // Unix socket for clients on this host, if any
+    const char *loop_tuning; // Scheduling of the loop thread, see -T
+    uint16_t snapshot_interval; // Seconds between two snapshots
+    uint16_t spectator_port; // Port GUIs connect to, 0 to serve them inline
+    uint16_t match_count; // Matches hosted by the process, 0 for a plain one
+    bool virtual_clock; // Jump to the next event when every player waits
+    bool reuseport; // Let other server processes share the port
     bool help; // Display help message
 } params_t;
 
@@ -0,0 +1,99 @@
+#include "client/client.h"
+
+#include "server.h"
+
+thread_local server_clock_t SERVER_CLOCK = { };
+
+/** A player is waiting when one of its commands is queued: until the reply
+comes, it cannot act, so skipping the time in between changes nothing to the
+game. Only the action lane counts: the death event, always queued, is a
+timer. A body restored from a snapshot has no client to act for it, so it is
+always waiting. **/
+
+static
+void mark_waiting_players(server_t *srv)
+{
+    const event_t *e;
+    client_state_t *client;
+
+    for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++)
+        srv->cm.clients[i].is_waiting = srv->cm.clients[i].fd < 0;
+    for (size_t i = 0; i < srv->events.actions.nmemb; i++) {
+        e = srv->events.actions.buff + i;
+        if (e->client_idx <= 0)
+            continue;
+        client = event_get_client(srv, e);
+        if (client != nullptr)
+            client->is_waiting = true;
+    }
+}
+
+static
+bool players_waiting(server_t *srv)
+{
+    if (srv->cm.idx_of_players == srv->cm.count)
+        return false;
+    mark_waiting_players(srv);
+    for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++)
+        if (!srv->cm.clients[i].is_waiting)
+            return false;
+    return true;
+}
+
+void server_poll_round(server_t *srv, int32_t timeout)
+{
+    handle_poll(srv, srv->intake_backlog ? 0 : timeout);
+    handle_fds_revents(srv);
+    process_clients_buff(srv);
+    handle_client_disconnection(srv);
+    disconnect_stalled_clients(srv);
+    flush_dirty_clients(srv);
+    if (UNLIKELY(srv->stats_requested)) {
+        server_dump_stats(srv, stderr);
+        srv->stats_requested = false;
+    }
+}
+
+void server_virtual_clock_step(server_t *srv)
+{
+    const event_t *next;
+    event_lane_t lane;
+    uint64_t due;
+
+    server_poll_round(srv, 0);
+    if (!srv->is_running)
+        return;
+    if (!players_waiting(srv)) {
+        server_poll_round(srv, -1);
+        return;
+    }
+    next = event_queue_peek(&srv->events, &lane);
+    due = next == nullptr ? UINT64_MAX : wall_time_of(srv, next->timestamp);
+    if (due == UINT64_MAX)
+        server_poll_round(srv, -1);
+    else if (due > SERVER_CLOCK.now)
+        SERVER_CLOCK.now = due;
+}
+
+void server_set_frequency(server_t *srv, uint16_t frequency)
+{
+    uint64_t now = get_timestamp();
+
+    srv->epoch_game = game_time_at(srv, now);
+    srv->epoch_wall = now;
+    srv->frequency = frequency;
+}
+
+void server_wall_clock_step(server_t *srv)
+{
+    int32_t to = compute_timeout(srv);
+
+    if (UNLIKELY(to > 0)) {
+        server_poll_round(srv, to);
+        return;
+    }
+    if (UNLIKELY(to < 0)) {
+        metrics_tick_overrun(srv->metrics, -to * MILISEC_IN_SEC);
+        DEBUG("Events are late by %d ms, skipping the wait", -to);
+    }
+}
@@ -1,7 +1,5 @@
 #define _GNU_SOURCE
 
-#include <arpa/inet.h>
-#include <signal.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -13,6 +11,8 @@
 
 #include "client/client.h"
 #include "game_events/names.h"
+#include "spectator/spectator.h"
+#include "utils/buffer_pool.h"
 #include "utils/debug.h"
 #include "utils/resizable_array.h"
 
@@ -21,42 +21,12 @@
 #include "server_args_parser.h"
 
 static
-void signal_handler(int signum, siginfo_t *info, void *context)
-{
-    static server_t *server = nullptr;
-
-    if (info == nullptr && !signum) {
-        server = (server_t *)context;
-        return;
-    }
-    if (signum == SIGINT || signum == SIGTERM) {
-        DEBUG_MSG("Received signal, shutting down server");
-        server->is_running = false;
-    }
-}
-
-static
-int socket_open(struct sockaddr_in *srv_sa)
-{
-    int fd = socket(AF_INET, SOCK_STREAM, 0);
-
-    if (fd < 0)
-        return -1;
-    if (
-        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &(int){1}, sizeof(int)) < 0
-        || bind(fd, (struct sockaddr *)srv_sa, sizeof *srv_sa) < 0
-    ) {
-        close(fd);
-        return -1;
-    }
-    return fd;
-}
-
-static
-bool setup_teams(server_t *srv, params_t *p, uint64_t timestamp)
+bool setup_teams(server_t *srv, params_t *p)
 {
     size_t t_counter = 0;
 
+    if (p->seed != 0)
+        srand(p->seed);
     for (; p->teams[t_counter] != nullptr; t_counter++);
     if (!sized_struct_ensure_capacity((resizable_array_t *)&srv->eggs,
         t_counter * p->team_capacity, sizeof(egg_t)))
@@ -65,7 +35,7 @@ bool setup_teams(server_t *srv, params_t *p, uint64_t timestamp)
         srv->team_names[t_idx] = p->teams[t_idx];
         for (size_t t_egg_id = 0; t_egg_id < p->team_capacity; t_egg_id++) {
             srv->eggs.buff[(t_idx * p->team_capacity) + t_egg_id] = (egg_t){
-                .hatch = timestamp, .team_id = t_idx, .id = srv->last_egg_id,
+                .hatch = 0, .team_id = t_idx, .id = srv->last_egg_id,
                 .x = rand() % p->map_width, .y = rand() % p->map_height};
             srv->last_egg_id++;
         }
@@ -75,88 +45,142 @@ bool setup_teams(server_t *srv, params_t *p, uint64_t timestamp)
 }
 
 static
-bool server_boot(server_t *srv, params_t *p)
+output_limits_t output_limits_from(const params_t *p)
+{
+    return (output_limits_t){
+        .high_water = (size_t)p->out_high_kib << 10,
+        .low_water = (size_t)p->out_low_kib << 10,
+        .stall_timeout = (uint64_t)p->out_stall_sec * MICROSEC_IN_SEC};
+}
+
+/**
+ * The Unix socket spares the AIs running on the server host the loopback TCP
+ * stack. Both listeners are gathered in an epoll set, which takes the server
+ * slot of the poll array.
+ */
+static
+bool server_listen_unix(server_t *srv, params_t *p)
+{
+    if (p->unix_path == nullptr)
+        return true;
+    srv->unix_fd = server_socket_listen_unix(p->unix_path, p->backlog);
+    if (srv->unix_fd < 0)
+        return perror("Can't open the unix socket"), false;
+    srv->unix_path = p->unix_path;
+    srv->cm.server_pfds[0].fd = server_socket_watch(srv->self_fd,
+        srv->unix_fd);
+    if (srv->cm.server_pfds[0].fd < 0)
+        return perror("Can't watch the listening sockets"), false;
+    return true;
+}
+
+static
+bool server_listen(server_t *srv, params_t *p)
 {
-    static constexpr const int BACKLOG = 32;
-    struct sockaddr_in default_sa = {
-        .sin_family = AF_INET, .sin_port = htons(p->port),
-        .sin_addr.s_addr = INADDR_ANY};
-    event_t meteor = { .timestamp = srv->start_time,
-        .client_idx = 0, .client_id = 0, .command = { METEOR }};
-
-    srv->self_fd = socket_open(&default_sa);
-    if (srv->self_fd < 0 || listen(srv->self_fd, BACKLOG) < 0)
+    srv->self_fd = server_socket_listen(p->port, p->reuseport, p->backlog);
+    if (srv->self_fd < 0)
         return perror("Can't open server socket"), false;
+    srv->cm.server_pfds[0].fd = srv->self_fd;
+    srv->cm.clients[0].fd = srv->self_fd;
+    return server_listen_unix(srv, p);
+}
+
+static
+bool server_boot(server_t *srv, params_t *p)
+{
+    event_t meteor = { .client_idx = 0, .client_id = 0, .timestamp = 0,
+        .command = { METEOR }, .opcode = metrics_opcode(METEOR) };
+
     srv->map_height = p->map_height;
     srv->map_width = p->map_width;
     srv->start_time = get_timestamp();
+    srv->epoch_wall = srv->start_time;
+    srv->epoch_game = 0;
     srv->frequency = p->frequency;
-    srv->cm.server_pfds[0].fd = srv->self_fd;
-    srv->cm.clients[0].fd = srv->self_fd;
-    meteor.timestamp = srv->start_time;
-    meteor.client_idx = 0;
-    return event_heap_push(&srv->events, &meteor);
+    srv->team_capacity = p->team_capacity;
+    srv->out_limits = output_limits_from(p);
+    return event_queue_push(&srv->events, &meteor, LANE_TIMER);
 }
 
 static
-bool server_allocate(server_t *srv, params_t *p, uint64_t timestamp)
+bool server_allocate(server_t *srv, params_t *p)
 {
-    struct sigaction sa = {
-        .sa_flags = SA_SIGINFO,
-        .sa_sigaction = signal_handler
-    };
-
-    if (sigaction(SIGINT, &sa, nullptr) < 0
-        || sigaction(SIGTERM, &sa, nullptr) < 0)
+    if (!srv->is_hosted && !install_signal_handlers(srv))
         return perror("Can't set signal handler"), false;
-    if (!setup_teams(srv, p, timestamp))
+    if (!setup_teams(srv, p))
         return false;
     if (!client_manager_init(&srv->cm))
         return perror("Can't initialize client manager"), false;
-    if (!event_heap_init(&srv->events))
+    if (!event_queue_init(&srv->events))
         return perror("Can't initialize event priority queue"), false;
-    signal_handler(0, nullptr, srv);
+    srv->metrics = metrics_create();
+    if (srv->metrics == nullptr)
+        return perror("Can't allocate metrics"), false;
     return true;
 }
 
-static
-void server_destroy(server_t *srv)
+bool server_start(server_t *srv, params_t *p)
 {
-    size_t fd_count = srv->cm.count;
+    return server_allocate(srv, p) && server_boot(srv, p);
+}
 
-    for (size_t i = 1; i < fd_count; i++) {
-        if (srv->cm.server_pfds[i].fd == srv->self_fd)
-            close(srv->self_fd);
-        if (srv->cm.server_pfds[i].fd != srv->self_fd)
-            remove_client(srv, i);
-    }
+void server_destroy(server_t *srv)
+{
+    const char *unix_path = srv->unix_path;
+
+    spectator_stop(srv);
+    while (srv->cm.count > 1)
+        remove_client(srv, srv->cm.count - 1);
+    server_close_listeners(srv);
+    if (unix_path != nullptr)
+        unlink(unix_path);
+    snapshot_finish(srv);
+    buffer_pool_purge();
     free(srv->eggs.buff);
     free(srv->cm.server_pfds);
     free(srv->cm.clients);
-    event_heap_free(&srv->events);
+    free(srv->cm.dirty);
+    gui_stream_close(&srv->gui_stream);
+    event_queue_free(&srv->events);
+    free(srv->metrics);
+    journal_close(srv->journal);
+    srv->journal = nullptr;
     srv->is_running = false;
 }
 
+void server_loop(server_t *srv)
+{
+    while (srv->is_running) {
+        server_handle_events(srv);
+        if (UNLIKELY(SERVER_CLOCK.is_virtual))
+            server_virtual_clock_step(srv);
+        else
+            server_wall_clock_step(srv);
+        snapshot_tick(srv);
+        spectator_sync(srv);
+    }
+}
+
 bool server_run(params_t *p, uint64_t timestamp)
 {
     server_t srv = {.self_fd = -1, .is_running = true};
+    snapshot_reader_t snap = { };
+    bool ok;
 
-    if (!server_allocate(&srv, p, timestamp) || !server_boot(&srv, p))
-        return server_destroy(&srv), false;
-    for (int32_t to; srv.is_running;) {
-        server_handle_events(&srv);
-        to = compute_timeout(&srv);
-        if (UNLIKELY(to > 0)) {
-            handle_poll(&srv, to);
-            handle_fds_revents(&srv);
-            process_clients_buff(&srv);
-            handle_client_disconnection(&srv);
-            continue;
-        }
-        if (UNLIKELY(to < 0))
-            fprintf(stderr, "WANRING: Server can't keep up with the events, "
-                "timeout is negative (%d ms), skipping tick\n", to);
+    if (p->virtual_clock) {
+        SERVER_CLOCK.is_virtual = true;
+        timestamp = SERVER_CLOCK.now;
+    }
+    if (p->restore_path != nullptr && !snapshot_reader_open(&snap, p))
+        return false;
+    ok = server_start(&srv, p) && snapshot_restore(&srv, &snap)
+        && server_listen(&srv, p) && journal_start(&srv, p, timestamp)
+        && spectator_start(&srv, p) && server_tune_loop(p, 0);
+    if (ok) {
+        snapshot_schedule(&srv.snapshot, p);
+        server_loop(&srv);
     }
     server_destroy(&srv);
-    return true;
+    snapshot_reader_close(&snap);
+    return ok;
 }
@@ -0,0 +1,72 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <signal.h>
+#include <stddef.h>
+
+#include "host/host.h"
+#include "utils/debug.h"
+
+#include "server.h"
+
+static
+void signal_handler(int signum, siginfo_t *info, void *context)
+{
+    static server_t *server = nullptr;
+
+    if (info == nullptr && !signum) {
+        server = (server_t *)context;
+        return;
+    }
+    if (signum == SIGINT || signum == SIGTERM) {
+        DEBUG_MSG("Received signal, shutting down server");
+        server->is_running = false;
+    }
+    if (signum == SIGUSR1)
+        server->stats_requested = true;
+}
+
+bool install_signal_handlers(server_t *srv)
+{
+    struct sigaction sa = {
+        .sa_flags = SA_SIGINFO,
+        .sa_sigaction = signal_handler
+    };
+
+    signal_handler(0, nullptr, srv);
+    return sigaction(SIGINT, &sa, nullptr) == 0
+        && sigaction(SIGTERM, &sa, nullptr) == 0
+        && sigaction(SIGUSR1, &sa, nullptr) == 0;
+}
+
+static
+void host_signal_handler(int signum, siginfo_t *info, void *context)
+{
+    static host_t *host = nullptr;
+    int saved_errno = errno;
+
+    if (info == nullptr && !signum) {
+        host = (host_t *)context;
+        return;
+    }
+    if (signum == SIGINT || signum == SIGTERM)
+        host->is_running = false;
+    if (signum == SIGUSR1)
+        for (size_t i = 0; i < host->match_count; i++)
+            if (host->matches[i].started)
+                match_order(host->matches + i, HANDOFF_DUMP_STATS);
+    errno = saved_errno;
+}
+
+bool install_host_signal_handlers(host_t *host)
+{
+    struct sigaction sa = {
+        .sa_flags = SA_SIGINFO,
+        .sa_sigaction = host_signal_handler
+    };
+
+    host_signal_handler(0, nullptr, host);
+    return sigaction(SIGINT, &sa, nullptr) == 0
+        && sigaction(SIGTERM, &sa, nullptr) == 0
+        && sigaction(SIGUSR1, &sa, nullptr) == 0;
+}
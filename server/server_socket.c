@@ -0,0 +1,100 @@
+#define _GNU_SOURCE
+
+#include <arpa/inet.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "server.h"
+
+static
+int socket_open(struct sockaddr_in *srv_sa, bool reuseport)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (fd < 0)
+        return -1;
+    if (
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &(int){1}, sizeof(int)) < 0
+        || (reuseport && setsockopt(
+            fd, SOL_SOCKET, SO_REUSEPORT, &(int){1}, sizeof(int)) < 0)
+        || bind(fd, (struct sockaddr *)srv_sa, sizeof *srv_sa) < 0
+    ) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int server_socket_listen(uint16_t port, bool reuseport, int backlog)
+{
+    struct sockaddr_in sa = {
+        .sin_family = AF_INET, .sin_port = htons(port),
+        .sin_addr.s_addr = INADDR_ANY};
+    int fd = socket_open(&sa, reuseport);
+
+    if (fd >= 0 && listen(fd, backlog) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int server_socket_listen_unix(const char *path, int backlog)
+{
+    struct sockaddr_un sa = { .sun_family = AF_UNIX };
+    struct stat st;
+    int fd;
+
+    if (strlen(path) >= sizeof sa.sun_path)
+        return errno = ENAMETOOLONG, -1;
+    strcpy(sa.sun_path, path);
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(path);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    if (bind(fd, (struct sockaddr *)&sa, sizeof sa) < 0
+        || listen(fd, backlog) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void server_close_listeners(server_t *srv)
+{
+    if (srv->self_fd >= 0)
+        close(srv->self_fd);
+    srv->self_fd = -1;
+    if (srv->unix_path == nullptr)
+        return;
+    close(srv->unix_fd);
+    if (srv->cm.server_pfds[0].fd >= 0)
+        close(srv->cm.server_pfds[0].fd);
+    srv->unix_path = nullptr;
+}
+
+int server_socket_watch(int first, int second)
+{
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev = { .events = EPOLLIN };
+
+    if (epoll_fd < 0)
+        return -1;
+    ev.data.fd = first;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, first, &ev) == 0) {
+        ev.data.fd = second;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, second, &ev) == 0)
+            return epoll_fd;
+    }
+    close(epoll_fd);
+    return -1;
+}
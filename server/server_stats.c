@@ -0,0 +1,59 @@
+#include <stdio.h>
+
+#include "client/client.h"
+#include "game_events/map_resources.h"
+#include "utils/buffer_pool.h"
+#include "server.h"
+
+static
+void dump_buffer_pool_stats(FILE *stream)
+{
+    const buffer_pool_stats_t *pool = buffer_pool_stats();
+    uint64_t requests = pool->hits + pool->misses;
+
+    fprintf(stream, "buffer pool: hits=%lu misses=%lu (%.1f%% hit) "
+        "resident=%zu cached=%zu\n", pool->hits, pool->misses,
+        requests ? (100.0 * (double)pool->hits) / (double)requests : 0.0,
+        pool->resident, pool->cached);
+}
+
+static
+void dump_accept_stats(server_t *srv, FILE *stream)
+{
+    const accept_stats_t *stats = &srv->accept_stats;
+
+    fprintf(stream, "accept: %lu connections in %lu batches (max %lu), "
+        "wait avg=%luus max=%luus\n", stats->accepted, stats->batches,
+        stats->batch_max,
+        stats->accepted ? stats->wait_total / stats->accepted : 0,
+        stats->wait_max);
+}
+
+static
+void dump_client(server_t *srv, client_state_t *client, FILE *stream,
+    uint64_t now)
+{
+    uint64_t age = now - client->connected_at;
+
+    fprintf(stream, "#%u fd=%d team=%s in=%zu out=%zu lines=%lu (%.1f/s) "
+        "throttled=%u%s\n", client->id, client->fd,
+        srv->team_names[client->team_id],
+        client->input.nmemb - client->in_buff_idx,
+        client->output.nmemb - client->out_buff_idx, client->intake_lines,
+        age ? (double)client->intake_lines * 1e6 / (double)age : 0.0,
+        client->intake_budget_hits, client->intake_paused ? " paused" : "");
+}
+
+void server_dump_stats(server_t *srv, FILE *stream)
+{
+    uint64_t now = get_timestamp();
+
+    fprintf(stream, "=== clients: %zu, pending events: %zu\n",
+        srv->cm.count - 1, event_queue_depth(&srv->events));
+    for (size_t i = 1; i < srv->cm.count; i++)
+        dump_client(srv, srv->cm.clients + i, stream, now);
+    dump_accept_stats(srv, stream);
+    map_resources_audit(srv, stream);
+    dump_buffer_pool_stats(stream);
+    fflush(stream);
+}
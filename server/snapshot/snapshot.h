@@ -0,0 +1,165 @@
+#ifndef SNAPSHOT_H_
+    #define SNAPSHOT_H_
+
+    #include <stdbool.h>
+    #include <stddef.h>
+    #include <stdint.h>
+    #include <sys/types.h>
+
+    #include "server_args_parser.h"
+
+/**
+ * @brief Bumped whenever the layout of the header or of a record changes.
+ *
+ */
+static constexpr const uint16_t SNAPSHOT_VERSION = 5;
+static constexpr const char SNAPSHOT_MAGIC[4] = { 'Z', 'S', 'N', 'P' };
+
+/**
+ * @brief Start of a snapshot, followed in order by:
+ * - names_size bytes holding the team_count team names, reserved ones
+ * included, each one NUL-terminated;
+ * - the map_height rows of map_width tiles;
+ * - egg_count snapshot_egg_t, player_count snapshot_player_t;
+ * - event_count snapshot_event_t, each one followed by its words.
+ *
+ * Times are stored relative to the moment the snapshot was taken, in wall
+ * time for the uptime, in game time for the deadlines.
+ */
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t frequency;
+    uint8_t map_width;
+    uint8_t map_height;
+    uint8_t team_capacity;
+    uint8_t team_count;
+    uint8_t last_egg_id;
+    uint16_t names_size;
+    uint32_t egg_count;
+    uint32_t player_count;
+    uint32_t event_count;
+    uint32_t next_client_id;
+    uint32_t next_seq; // Sequence number of the next pushed event
+    uint64_t elapsed; // Time since the server booted, in microseconds
+    uint64_t game_time; // Game time when the snapshot was taken
+    uint64_t food_tick; // Last tick of the food wheel swept
+} snapshot_header_t;
+
+typedef struct {
+    uint64_t hatch_in; // In game time, 0 once hatched
+    uint8_t team_id;
+    uint8_t id;
+    uint8_t x;
+    uint8_t y;
+} snapshot_egg_t;
+
+typedef struct {
+    uint32_t qnts[7];
+    uint32_t id;
+    uint8_t team_id;
+    uint8_t x;
+    uint8_t y;
+    uint8_t tier;
+    uint8_t orientation;
+    uint8_t meal_phase;
+    bool is_in_incantation;
+} snapshot_player_t;
+
+/**
+ * @brief Fixed part of a queued event, followed by length bytes holding its
+ * NUL-terminated words.
+ */
+typedef struct {
+    int64_t due_in; // In game time, negative when the event is overdue
+    int32_t client_id; // -1 for the server's own events
+    uint32_t seq;
+    uint16_t length;
+} snapshot_event_t;
+
+/**
+ * @brief Periodic snapshot settings, and the child writing the current one.
+ *
+ */
+typedef struct {
+    const char *path;
+    uint64_t interval; // in microseconds
+    uint64_t due_at; // Monotonic time of the next snapshot
+    uint64_t forked_at;
+    pid_t child; // 0 when no snapshot is being written
+} snapshot_schedule_t;
+
+/**
+ * @brief A snapshot file mapped in memory, kept until the server is
+ * destroyed as the team names point into it.
+ */
+typedef struct {
+    char *map;
+    size_t size;
+    size_t offset;
+    snapshot_header_t header;
+    char *teams[TEAM_COUNT_LIMIT];
+} snapshot_reader_t;
+
+typedef struct server_s server_t;
+
+/**
+ * @brief Writes the simulation state of the server, as it is at the given
+ * timestamp, to a file.
+ *
+ * @param srv
+ * @param path
+ * @param now
+ * @return false if the file could not be written
+ */
+bool snapshot_write(server_t *srv, const char *path, uint64_t now);
+/**
+ * @brief Arms the periodic snapshots, if a snapshot file was given.
+ *
+ * @param sched
+ * @param p
+ */
+void snapshot_schedule(snapshot_schedule_t *sched, const params_t *p);
+/**
+ * @brief Reaps the child writing the last snapshot, then forks a new one
+ * if it is due. Only the fork is spent in the main loop.
+ *
+ * @param srv
+ */
+void snapshot_tick(server_t *srv);
+/**
+ * @brief Waits for the snapshot being written, if any.
+ *
+ * @param srv
+ */
+void snapshot_finish(server_t *srv);
+
+/**
+ * @brief Maps the snapshot file given with -r and takes the world
+ * parameters from it.
+ *
+ * @param reader
+ * @param p
+ * @return false if the file is missing or is not a snapshot
+ */
+bool snapshot_reader_open(snapshot_reader_t *reader, params_t *p);
+/**
+ * @brief Consumes the next bytes of the snapshot.
+ *
+ * @param reader
+ * @param size
+ * @return char* The bytes, or nullptr if the file is too short.
+ */
+char *snapshot_reader_take(snapshot_reader_t *reader, size_t size);
+/**
+ * @brief Replaces the world of a freshly started server with the snapshot
+ * one. Does nothing if no snapshot was opened.
+ *
+ * @param srv
+ * @param reader
+ * @return false if the snapshot is truncated or an allocation failed
+ */
+bool snapshot_restore(server_t *srv, snapshot_reader_t *reader);
+void snapshot_reader_close(snapshot_reader_t *reader);
+
+#endif /* !SNAPSHOT_H_ */
@@ -0,0 +1,93 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "server.h"
+
+#include "snapshot.h"
+
+/** Snapshots are written by a forked child, from its copy-on-write view of
+the server memory: the main loop only pays for the fork itself, the page
+tables being copied, and for the pages it writes to while the child runs.
+Both are recorded, the fork as the pause and the time until the child was
+reaped as the duration. A single child runs at a time; a snapshot falling
+due while the previous one is still being written waits for it. **/
+
+static
+uint64_t monotonic_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * MICROSEC_IN_SEC + ts.tv_nsec / 1000;
+}
+
+void snapshot_schedule(snapshot_schedule_t *sched, const params_t *p)
+{
+    *sched = (snapshot_schedule_t){ .path = p->snapshot_path,
+        .interval = (uint64_t)p->snapshot_interval * MICROSEC_IN_SEC };
+    sched->due_at = monotonic_us() + sched->interval;
+}
+
+static
+void snapshot_reap(server_t *srv, int options)
+{
+    snapshot_schedule_t *sched = &srv->snapshot;
+    int status;
+    pid_t pid = waitpid(sched->child, &status, options);
+
+    if (pid == 0)
+        return;
+    sched->child = 0;
+    if (pid > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        histogram_record(&srv->metrics->snapshot_duration,
+            monotonic_us() - sched->forked_at);
+        return;
+    }
+    srv->metrics->snapshot_failures++;
+    fprintf(stderr, "Snapshot to %s failed\n", sched->path);
+}
+
+static
+void snapshot_fork(server_t *srv, uint64_t started)
+{
+    snapshot_schedule_t *sched = &srv->snapshot;
+    uint64_t now = get_timestamp();
+    pid_t pid = fork();
+
+    if (pid == 0)
+        _exit(snapshot_write(srv, sched->path, now) ? 0 : 1);
+    sched->forked_at = monotonic_us();
+    sched->due_at = started + sched->interval;
+    if (pid < 0) {
+        srv->metrics->snapshot_failures++;
+        perror("Can't fork the snapshot writer");
+        return;
+    }
+    sched->child = pid;
+    histogram_record(&srv->metrics->snapshot_pause,
+        sched->forked_at - started);
+    DEBUG("Snapshot forked in %lu µs", sched->forked_at - started);
+}
+
+void snapshot_tick(server_t *srv)
+{
+    uint64_t now;
+
+    if (srv->snapshot.path == nullptr)
+        return;
+    if (srv->snapshot.child > 0)
+        snapshot_reap(srv, WNOHANG);
+    now = monotonic_us();
+    if (srv->snapshot.child == 0 && now >= srv->snapshot.due_at)
+        snapshot_fork(srv, now);
+}
+
+void snapshot_finish(server_t *srv)
+{
+    if (srv->snapshot.child > 0)
+        snapshot_reap(srv, 0);
+}
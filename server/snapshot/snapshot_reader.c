@@ -0,0 +1,111 @@
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "client/client.h"
+#include "server.h"
+
+#include "snapshot.h"
+
+char *snapshot_reader_take(snapshot_reader_t *reader, size_t size)
+{
+    char *data = reader->map + reader->offset;
+
+    if (size > reader->size - reader->offset)
+        return nullptr;
+    reader->offset += size;
+    return data;
+}
+
+static
+bool read_team_names(snapshot_reader_t *reader)
+{
+    char *name = reader->map + reader->offset;
+    char *end;
+    char *nul;
+
+    if (snapshot_reader_take(reader, reader->header.names_size) == nullptr)
+        return false;
+    end = reader->map + reader->offset;
+    for (size_t i = 0; i < reader->header.team_count; i++) {
+        nul = memchr(name, '\0', end - name);
+        if (nul == nullptr)
+            return false;
+        reader->teams[i] = name;
+        name = nul + 1;
+    }
+    reader->teams[reader->header.team_count] = nullptr;
+    return true;
+}
+
+static
+bool read_header(snapshot_reader_t *reader)
+{
+    const snapshot_header_t *header = &reader->header;
+    const char *data = snapshot_reader_take(reader, sizeof *header);
+
+    if (data == nullptr)
+        return false;
+    memcpy(&reader->header, data, sizeof *header);
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof SNAPSHOT_MAGIC)
+        || header->version != SNAPSHOT_VERSION
+        || header->map_width == 0 || header->map_width > MAP_MAX_SIDE_SIZE
+        || header->map_height == 0 || header->map_height > MAP_MAX_SIDE_SIZE
+        || header->team_count <= TEAM_ID_GRAPHIC || header->frequency == 0
+        || header->team_capacity == 0)
+        return false;
+    return read_team_names(reader);
+}
+
+static
+bool map_file(snapshot_reader_t *reader, const char *path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+
+    if (fd < 0)
+        return perror(path), false;
+    if (fstat(fd, &st) < 0)
+        return close(fd), perror(path), false;
+    reader->size = st.st_size;
+    reader->map = mmap(nullptr, reader->size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (reader->map != MAP_FAILED)
+        return true;
+    reader->map = nullptr;
+    return perror(path), false;
+}
+
+bool snapshot_reader_open(snapshot_reader_t *reader, params_t *p)
+{
+    if (p->journal_path != nullptr)
+        return fprintf(stderr, "A journal cannot start from a snapshot, "
+            "as it could not be replayed\n"), false;
+    if (!map_file(reader, p->restore_path))
+        return false;
+    if (!read_header(reader)) {
+        fprintf(stderr, "%s: not a version %u snapshot\n", p->restore_path,
+            SNAPSHOT_VERSION);
+        return snapshot_reader_close(reader), false;
+    }
+    p->teams = reader->teams;
+    p->registered_team_count = reader->header.team_count;
+    p->frequency = reader->header.frequency;
+    p->map_width = reader->header.map_width;
+    p->map_height = reader->header.map_height;
+    p->team_capacity = reader->header.team_capacity;
+    return true;
+}
+
+void snapshot_reader_close(snapshot_reader_t *reader)
+{
+    if (reader->map != nullptr)
+        munmap(reader->map, reader->size);
+    reader->map = nullptr;
+}
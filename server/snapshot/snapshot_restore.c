@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "client/client.h"
+#include "game_events/map_resources.h"
+#include "utils/resizable_array.h"
+
+#include "server.h"
+#include "snapshot.h"
+
+/** Restoring happens on a freshly started server, before it listens: the
+booted world is overwritten, and the event queue is refilled with the events
+of the snapshot, each one keeping its push order. The players come back as
+bodies without a connection, living on until they starve, since the sockets
+of their clients were lost with the previous process. **/
+
+static
+bool restore_map(server_t *srv, snapshot_reader_t *reader)
+{
+    size_t row = srv->map_width * sizeof **srv->map;
+    const char *data;
+
+    for (size_t y = 0; y < srv->map_height; y++) {
+        data = snapshot_reader_take(reader, row);
+        if (data == nullptr)
+            return false;
+        memcpy(srv->map[y], data, row);
+    }
+    // Recounted rather than saved, so a drifted total cannot survive a restore
+    srv->total_item_in_map = map_resources_count(srv);
+    return true;
+}
+
+static
+bool restore_eggs(server_t *srv, snapshot_reader_t *reader,
+    uint64_t game_time)
+{
+    size_t count = reader->header.egg_count;
+    const char *data = snapshot_reader_take(reader,
+        count * sizeof(snapshot_egg_t));
+    snapshot_egg_t egg;
+
+    srv->eggs.nmemb = 0;
+    if (data == nullptr || !sized_struct_ensure_capacity(
+        (resizable_array_t *)&srv->eggs, count, sizeof(egg_t)))
+        return false;
+    for (size_t i = 0; i < count; i++) {
+        memcpy(&egg, data + i * sizeof egg, sizeof egg);
+        srv->eggs.buff[i] = (egg_t){ .hatch = game_time + egg.hatch_in,
+            .team_id = egg.team_id, .id = egg.id,
+            .x = egg.x % srv->map_width, .y = egg.y % srv->map_height };
+    }
+    srv->eggs.nmemb = count;
+    return true;
+}
+
+static
+bool read_player(snapshot_reader_t *reader, snapshot_player_t *rec)
+{
+    const char *data = snapshot_reader_take(reader, sizeof *rec);
+
+    if (data == nullptr)
+        return false;
+    memcpy(rec, data, sizeof *rec);
+    return rec->team_id > TEAM_ID_GRAPHIC
+        && rec->team_id < reader->header.team_count;
+}
+
+static
+bool restore_player(server_t *srv, snapshot_reader_t *reader)
+{
+    snapshot_player_t rec;
+    client_state_t *client;
+
+    if (!read_player(reader, &rec))
+        return false;
+    client = client_manager_add(&srv->cm);
+    if (client == nullptr)
+        return false;
+    *client = (client_state_t){ .id = rec.id, .team_id = rec.team_id,
+        .x = rec.x % srv->map_width, .y = rec.y % srv->map_height,
+        .tier = rec.tier, .orientation = rec.orientation % 4,
+        .is_in_incantation = rec.is_in_incantation,
+        .meal_phase = rec.meal_phase % FOOD_PERIOD, .fd = -1 };
+    memcpy(client->inv.qnts, rec.qnts, sizeof rec.qnts);
+    return client_manager_promote(&srv->cm, client - srv->cm.clients)
+        != nullptr;
+}
+
+static
+bool restore_players(server_t *srv, snapshot_reader_t *reader)
+{
+    for (size_t i = 0; i < reader->header.player_count; i++)
+        if (!restore_player(srv, reader))
+            return false;
+    for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++) {
+        player_census_add(srv, srv->cm.clients + i, 1);
+        food_wheel_count(srv, srv->cm.clients + i, 1);
+    }
+    return true;
+}
+
+static
+bool split_words(event_t *event, char *words, size_t length)
+{
+    size_t i = 0;
+
+    if (length == 0 || words[length - 1] != '\0')
+        return false;
+    for (size_t off = 0; off < length; off += strlen(words + off) + 1) {
+        if (i == COMMAND_WORD_COUNT - 1)
+            return false;
+        event->command[i] = words + off;
+        i++;
+    }
+    return true;
+}
+
+static
+bool bind_client(server_t *srv, event_t *event, int32_t id)
+{
+    client_state_t *client;
+
+    if (id < 0)
+        return true;
+    client = client_from_id(srv, id);
+    if (client == nullptr || client->team_id <= TEAM_ID_GRAPHIC)
+        return false;
+    event->client_id = id;
+    event->client_idx = client - srv->cm.clients;
+    return true;
+}
+
+static
+bool restore_event(server_t *srv, snapshot_reader_t *reader,
+    uint64_t game_time)
+{
+    char *data = snapshot_reader_take(reader, sizeof(snapshot_event_t));
+    snapshot_event_t rec;
+    event_t event = { };
+
+    if (data == nullptr)
+        return false;
+    memcpy(&rec, data, sizeof rec);
+    data = snapshot_reader_take(reader, rec.length);
+    if (data == nullptr || !split_words(&event, data, rec.length)
+        || !bind_client(srv, &event, rec.client_id))
+        return false;
+    event.timestamp = game_time + rec.due_in;
+    event.opcode = metrics_opcode(event.command[0]);
+    srv->events.next_seq = rec.seq;
+    return event_queue_push(&srv->events, &event,
+        rec.client_id < 0 ? LANE_TIMER : LANE_ACTION);
+}
+
+static
+bool restore_queue(server_t *srv, snapshot_reader_t *reader,
+    uint64_t game_time)
+{
+    event_queue_free(&srv->events);
+    if (!event_queue_init(&srv->events))
+        return false;
+    for (size_t i = 0; i < reader->header.event_count; i++)
+        if (!restore_event(srv, reader, game_time))
+            return false;
+    srv->events.next_seq = reader->header.next_seq;
+    return true;
+}
+
+bool snapshot_restore(server_t *srv, snapshot_reader_t *reader)
+{
+    uint64_t now = get_timestamp();
+
+    if (reader->map == nullptr)
+        return true;
+    srv->start_time = now - reader->header.elapsed;
+    srv->last_egg_id = reader->header.last_egg_id;
+    srv->next_client_id = reader->header.next_client_id;
+    srv->epoch_wall = now;
+    srv->epoch_game = reader->header.game_time;
+    srv->food = (food_wheel_t){ .tick = reader->header.food_tick };
+    if (!restore_map(srv, reader)
+        || !restore_eggs(srv, reader, srv->epoch_game)
+        || !restore_players(srv, reader)
+        || !restore_queue(srv, reader, srv->epoch_game)
+        || !food_wheel_arm_next(srv))
+        return fprintf(stderr, "Can't restore the snapshot\n"), false;
+    DEBUG("Restored %u players and %u events from the snapshot",
+        reader->header.player_count, reader->header.event_count);
+    return true;
+}
@@ -0,0 +1,175 @@
+#define _GNU_SOURCE
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "client/client.h"
+#include "game_events/names.h"
+#include "utils/common_macros.h"
+#include "server.h"
+
+#include "snapshot.h"
+
+/** The snapshot is written to a temporary file renamed over the previous
+one once synced, so that a crash while writing never leaves a torn file in
+place of a good one. Only the events of players and of the server itself are
+kept: the other clients' connections do not outlive the process. The food
+sweep is left out too, as it is armed again from the saved wheel. **/
+
+static
+void fill_header(server_t *srv, snapshot_header_t *header, uint64_t now)
+{
+    *header = (snapshot_header_t){ .version = SNAPSHOT_VERSION,
+        .frequency = srv->frequency, .map_width = srv->map_width,
+        .map_height = srv->map_height, .team_capacity = srv->team_capacity,
+        .last_egg_id = srv->last_egg_id,
+        .egg_count = srv->eggs.nmemb,
+        .player_count = srv->cm.count - srv->cm.idx_of_players,
+        .next_client_id = srv->next_client_id,
+        .next_seq = srv->events.next_seq,
+        .elapsed = now - srv->start_time,
+        .game_time = game_time_at(srv, now), .food_tick = srv->food.tick };
+    memcpy(header->magic, SNAPSHOT_MAGIC, sizeof SNAPSHOT_MAGIC);
+    for (; srv->team_names[header->team_count] != nullptr;
+        header->team_count++)
+        header->names_size += strlen(srv->team_names[header->team_count]) + 1;
+}
+
+static
+bool write_world(server_t *srv, FILE *file, uint64_t game_time)
+{
+    snapshot_egg_t egg;
+    egg_t *src;
+
+    for (size_t y = 0; y < srv->map_height; y++)
+        if (fwrite(srv->map[y], sizeof **srv->map, srv->map_width, file)
+            != srv->map_width)
+            return false;
+    for (size_t i = 0; i < srv->eggs.nmemb; i++) {
+        src = srv->eggs.buff + i;
+        egg = (snapshot_egg_t){ .team_id = src->team_id, .id = src->id,
+            .x = src->x, .y = src->y,
+            .hatch_in = (src->hatch <= game_time) ? 0
+                : src->hatch - game_time };
+        if (fwrite(&egg, sizeof egg, 1, file) != 1)
+            return false;
+    }
+    return true;
+}
+
+static
+bool write_players(server_t *srv, FILE *file)
+{
+    snapshot_player_t player;
+    client_state_t *src;
+
+    for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++) {
+        src = srv->cm.clients + i;
+        player = (snapshot_player_t){ .id = src->id, .team_id = src->team_id,
+            .x = src->x, .y = src->y, .tier = src->tier,
+            .orientation = src->orientation, .meal_phase = src->meal_phase,
+            .is_in_incantation = src->is_in_incantation };
+        memcpy(player.qnts, src->inv.qnts, sizeof player.qnts);
+        if (fwrite(&player, sizeof player, 1, file) != 1)
+            return false;
+    }
+    return true;
+}
+
+static
+bool is_kept(server_t *srv, const event_t *event)
+{
+    const client_state_t *client;
+
+    if (event->client_idx == 0)
+        return strcmp(event->command[0], PLAYER_DEATH) != 0;
+    if (event->client_idx < 0)
+        return false;
+    client = event_get_client(srv, event);
+    return client != nullptr && client->team_id > TEAM_ID_GRAPHIC;
+}
+
+static
+bool write_event(FILE *file, const event_t *src, uint64_t game_time)
+{
+    snapshot_event_t event = {
+        .due_in = (int64_t)(src->timestamp - game_time),
+        .client_id = (src->client_idx == 0) ? -1 : src->client_id,
+        .seq = src->seq };
+
+    for (size_t i = 0; i < src->arg_count; i++)
+        event.length += strlen(src->command[i]) + 1;
+    if (fwrite(&event, sizeof event, 1, file) != 1)
+        return false;
+    for (size_t i = 0; i < src->arg_count; i++)
+        if (fwrite(src->command[i], strlen(src->command[i]) + 1, 1, file)
+            != 1)
+            return false;
+    return true;
+}
+
+/**
+ * The GUI lane is left out: its queries die with their connections.
+ */
+static
+bool write_events(server_t *srv, FILE *file, snapshot_header_t *header,
+    uint64_t game_time)
+{
+    const event_heap_t *lanes[] = { &srv->events.timers,
+        &srv->events.actions };
+    const event_t *event;
+
+    for (size_t lane = 0; lane < LENGTH_OF(lanes); lane++)
+        for (size_t i = 0; i < lanes[lane]->nmemb; i++) {
+            event = lanes[lane]->buff + i;
+            if (!is_kept(srv, event))
+                continue;
+            if (!write_event(file, event, game_time))
+                return false;
+            header->event_count++;
+        }
+    return true;
+}
+
+static
+bool write_snapshot(server_t *srv, FILE *file, uint64_t now)
+{
+    snapshot_header_t header;
+
+    fill_header(srv, &header, now);
+    if (fwrite(&header, sizeof header, 1, file) != 1)
+        return false;
+    for (size_t i = 0; i < header.team_count; i++)
+        if (fwrite(srv->team_names[i], strlen(srv->team_names[i]) + 1, 1,
+            file) != 1)
+            return false;
+    if (!write_world(srv, file, header.game_time)
+        || !write_players(srv, file)
+        || !write_events(srv, file, &header, header.game_time))
+        return false;
+    return fseek(file, 0, SEEK_SET) == 0
+        && fwrite(&header, sizeof header, 1, file) == 1
+        && fflush(file) == 0 && fsync(fileno(file)) == 0;
+}
+
+bool snapshot_write(server_t *srv, const char *path, uint64_t now)
+{
+    char tmp[PATH_MAX];
+    FILE *file;
+    bool ok;
+
+    if ((size_t)snprintf(tmp, sizeof tmp, "%s.tmp", path) >= sizeof tmp)
+        return false;
+    file = fopen(tmp, "we");
+    if (file == nullptr)
+        return perror(tmp), false;
+    ok = write_snapshot(srv, file, now);
+    if (fclose(file) != 0 || !ok || rename(tmp, path) < 0) {
+        perror(path);
+        unlink(tmp);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+#include <string.h>
+
+#include "feed.h"
+#include "spectator.h"
+
+/** The simulation reports every change a GUI is told about as a fixed-size
+record, instead of a message. Without an observer, the record is formatted
+on the spot, and nothing at all is done while no GUI is connected, unless
+the GUI stream records it for the GUIs to come back. With one, it is queued in
+the ring, and the formatting is left to the observer, which keeps its own copy
+of the world up to date from the same records. **/
+
+const feed_kind_t FEED_KINDS[FEED_TYPE_COUNT] = {
+    [FEED_PLAYER_JOIN] = { feed_player_join, true, false },
+    [FEED_PLAYER_GONE] = { feed_player_gone, false, false },
+    [FEED_POSITION] = { feed_position, true, false },
+    [FEED_INVENTORY] = { feed_inventory, true, false },
+    [FEED_LEVEL] = { feed_level, true, false },
+    [FEED_OBJECT] = { feed_object, true, true },
+    [FEED_EXPULSION] = { feed_expulsion, true, false },
+    [FEED_BROADCAST] = { feed_broadcast, false, false },
+    [FEED_FORK] = { feed_fork, false, false },
+    [FEED_EGG_LAID] = { feed_egg_laid, false, false },
+    [FEED_EGG_GONE] = { feed_egg_gone, false, false },
+    [FEED_INCANTATION] = { feed_incantation, false, false },
+    [FEED_INCANTATION_END] = { feed_incantation_end, false, false },
+    [FEED_GAME_END] = { feed_game_end, false, false },
+    [FEED_MEALS] = { feed_meals, false, false },
+    [FEED_TILE] = { nullptr, false, true },
+};
+
+void feed_format(server_t *srv, const feed_t *feed, const char *text)
+{
+    if (feed->type < FEED_TYPE_COUNT && FEED_KINDS[feed->type].format)
+        FEED_KINDS[feed->type].format(srv, feed, text);
+}
+
+void gui_feed(server_t *srv, const feed_t *feed, const char *text)
+{
+    feed_t record;
+
+    if (LIKELY(srv->spectator == nullptr)) {
+        if (gui_audience(srv))
+            feed_format(srv, feed, text);
+        return;
+    }
+    record = *feed;
+    record.length = text == nullptr ? 0 : strlen(text) + 1;
+    if (spectator_ring_push(srv->spectator, &record, text))
+        srv->metrics->spectator_feed_bytes += sizeof record + record.length;
+}
+
+void gui_feed_player(server_t *srv, uint8_t type, const client_state_t *cs)
+{
+    feed_t feed = feed_of_player(type, cs);
+
+    gui_feed(srv, &feed, nullptr);
+}
@@ -0,0 +1,35 @@
+#ifndef FEED_H_
+    #define FEED_H_
+
+    #include "spectator.h"
+
+/**
+ * @brief How a kind of state change is formatted, and which part of the
+ * observer's world it updates.
+ */
+typedef struct {
+    void (*format)(server_t *, const feed_t *, const char *);
+    bool has_player; // Carries the whole state of the player id
+    bool has_tile; // Carries the content of the tile x, y
+} feed_kind_t;
+
+extern const feed_kind_t FEED_KINDS[FEED_TYPE_COUNT];
+
+void feed_player_join(server_t *srv, const feed_t *feed, const char *);
+void feed_player_gone(server_t *srv, const feed_t *feed, const char *);
+void feed_position(server_t *srv, const feed_t *feed, const char *);
+void feed_inventory(server_t *srv, const feed_t *feed, const char *);
+void feed_level(server_t *srv, const feed_t *feed, const char *);
+void feed_object(server_t *srv, const feed_t *feed, const char *);
+void feed_expulsion(server_t *srv, const feed_t *feed, const char *);
+void feed_broadcast(server_t *srv, const feed_t *feed, const char *text);
+void feed_fork(server_t *srv, const feed_t *feed, const char *);
+
+void feed_egg_laid(server_t *srv, const feed_t *feed, const char *);
+void feed_egg_gone(server_t *srv, const feed_t *feed, const char *);
+void feed_incantation(server_t *srv, const feed_t *feed, const char *);
+void feed_incantation_end(server_t *srv, const feed_t *feed, const char *);
+void feed_game_end(server_t *srv, const feed_t *feed, const char *);
+void feed_meals(server_t *srv, const feed_t *feed, const char *);
+
+#endif /* !FEED_H_ */
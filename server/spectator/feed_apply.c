@@ -0,0 +1,125 @@
+#include <string.h>
+
+#include "client/client.h"
+#include "utils/resizable_array.h"
+
+#include "feed.h"
+
+/** The observer was forked with the world as it was at that moment, and the
+records apply the changes in the order they happened, so its eggs and
+players line up with the simulation ones. Players are looked up in the
+player section only: the observer numbers its GUIs on its own. **/
+
+static
+client_state_t *observed_player(server_t *srv, uint32_t id)
+{
+    for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++)
+        if (srv->cm.clients[i].id == id)
+            return srv->cm.clients + i;
+    return nullptr;
+}
+
+static
+void remove_egg(server_t *srv, uint32_t index)
+{
+    if (index >= srv->eggs.nmemb)
+        return;
+    srv->eggs.buff[index] = srv->eggs.buff[srv->eggs.nmemb - 1];
+    srv->eggs.nmemb--;
+}
+
+static
+void add_egg(server_t *srv, const feed_t *feed)
+{
+    if (!sized_struct_ensure_capacity((resizable_array_t *)&srv->eggs, 1,
+        sizeof *srv->eggs.buff))
+        return;
+    srv->eggs.buff[srv->eggs.nmemb] = (egg_t){ .team_id = feed->team_id,
+        .x = feed->x, .y = feed->y };
+    srv->eggs.nmemb++;
+}
+
+static
+void add_player(server_t *srv, const feed_t *feed)
+{
+    client_state_t *client = client_manager_add(&srv->cm);
+
+    remove_egg(srv, feed->index);
+    if (client == nullptr)
+        return;
+    client->id = feed->id;
+    client->team_id = feed->team_id;
+    client->x = feed->x;
+    client->y = feed->y;
+    client->tier = feed->tier;
+    client->meal_phase = feed->meal_phase;
+    player_census_add(srv, client, 1);
+    food_wheel_count(srv, client, 1);
+    client_manager_promote(&srv->cm, client - srv->cm.clients);
+}
+
+static
+void update_player(server_t *srv, const feed_t *feed)
+{
+    client_state_t *player = observed_player(srv, feed->id);
+
+    if (player == nullptr)
+        return;
+    player_census_add(srv, player, -1);
+    player->x = feed->x;
+    player->y = feed->y;
+    player->orientation = feed->orientation;
+    player->tier = feed->tier;
+    player->inv = feed->inv;
+    player_census_add(srv, player, 1);
+}
+
+static
+void remove_player(server_t *srv, uint32_t id)
+{
+    client_state_t *player = observed_player(srv, id);
+
+    if (player != nullptr)
+        remove_client(srv, player - srv->cm.clients);
+}
+
+static
+void eat_meals(server_t *srv, uint32_t phase)
+{
+    client_state_t *player;
+
+    for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++) {
+        player = srv->cm.clients + i;
+        player->inv.food -= player->meal_phase == phase;
+    }
+}
+
+static
+void apply_roster(server_t *srv, const feed_t *feed)
+{
+    if (feed->type == FEED_PLAYER_JOIN)
+        add_player(srv, feed);
+    if (feed->type == FEED_EGG_LAID)
+        add_egg(srv, feed);
+    if (feed->type == FEED_EGG_GONE)
+        remove_egg(srv, feed->index);
+    if (feed->type == FEED_MEALS)
+        eat_meals(srv, feed->index);
+}
+
+void feed_apply(server_t *srv, const feed_t *feed, const char *text)
+{
+    if (feed->type >= FEED_TYPE_COUNT)
+        return;
+    if (feed->type == FEED_PLAYER_GONE) {
+        remove_player(srv, feed->id);
+        return;
+    }
+    apply_roster(srv, feed);
+    if (FEED_KINDS[feed->type].has_player)
+        update_player(srv, feed);
+    if (FEED_KINDS[feed->type].has_tile)
+        srv->map[feed->y % srv->map_height][feed->x % srv->map_width] =
+            feed->tile;
+    feed_format(srv, feed, text);
+}
@@ -0,0 +1,70 @@
+#include "client/client.h"
+#include "game_events/names.h"
+#include "proto_writer.h"
+
+#include "feed.h"
+
+void feed_player_join(server_t *srv, const feed_t *feed, const char *)
+{
+    send_to_guis(srv,
+        "pnw #%d %hhu %hhu %hhu %hhu %s\npin #%d %hhu %hhu %s\nebo #%zu\n",
+        feed->id, feed->x, feed->y, feed->orientation + 1,
+        feed->tier, srv->team_names[feed->team_id],
+        feed->id, feed->x, feed->y,
+        serialize_inventory(&feed->inv), (size_t)feed->index + 1);
+}
+
+void feed_player_gone(server_t *srv, const feed_t *feed, const char *)
+{
+    send_to_guis(srv, "pdi #%hd\n", feed->id);
+}
+
+void feed_position(server_t *srv, const feed_t *feed, const char *)
+{
+    char msg[PROTO_TILE_MSG_MAX_LEN];
+
+    append_bytes_to_guis(srv, msg, proto_ppo(msg, feed->id,
+        (uint8_t []){ feed->x, feed->y }, feed->orientation) - msg);
+}
+
+void feed_inventory(server_t *srv, const feed_t *feed, const char *)
+{
+    char msg[PROTO_TILE_MSG_MAX_LEN];
+
+    append_bytes_to_guis(srv, msg, proto_pin(msg, feed->id,
+        (uint8_t []){ feed->x, feed->y }, &feed->inv) - msg);
+}
+
+void feed_level(server_t *srv, const feed_t *feed, const char *)
+{
+    char msg[PROTO_TILE_MSG_MAX_LEN];
+
+    append_bytes_to_guis(srv, msg,
+        proto_plv(msg, feed->id, feed->tier) - msg);
+}
+
+void feed_object(server_t *srv, const feed_t *feed, const char *)
+{
+    char msg[2 * PROTO_TILE_MSG_MAX_LEN];
+    char *end = proto_pin(msg, feed->id,
+        (uint8_t []){ feed->x, feed->y }, &feed->inv);
+
+    end = proto_bct(end, feed->x, feed->y, &feed->tile);
+    append_bytes_to_guis(srv, msg, end - msg);
+}
+
+void feed_expulsion(server_t *srv, const feed_t *feed, const char *)
+{
+    send_to_guis(srv, "pex %hu\nppo %hu %hhu %hhu %hhu\n",
+        feed->id, feed->id, feed->x, feed->y, feed->orientation);
+}
+
+void feed_broadcast(server_t *srv, const feed_t *feed, const char *text)
+{
+    send_to_guis(srv, "pbc #%hd %s\n", feed->id, text);
+}
+
+void feed_fork(server_t *srv, const feed_t *feed, const char *)
+{
+    send_to_guis(srv, "pfk #%hu\n", feed->id);
+}
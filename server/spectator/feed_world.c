@@ -0,0 +1,66 @@
+#include "client/client.h"
+#include "game_events/names.h"
+#include "proto_writer.h"
+
+#include "feed.h"
+
+void feed_egg_laid(server_t *srv, const feed_t *feed, const char *)
+{
+    send_to_guis(srv, "enw #%zu #%hu %hhu %hhu\n",
+        (size_t)feed->index, feed->id, feed->x, feed->y);
+}
+
+void feed_egg_gone(server_t *srv, const feed_t *feed, const char *)
+{
+    send_to_guis(srv, "edi %hu\n", feed->id);
+}
+
+void feed_incantation(server_t *srv, const feed_t *feed, const char *)
+{
+    const client_state_t *player;
+
+    send_to_guis(srv, "pic %hhu %hhu %hhu", feed->x, feed->y, feed->tier);
+    for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++) {
+        player = srv->cm.clients + i;
+        if (player->x == feed->x && player->y == feed->y
+            && player->tier == feed->tier)
+            send_to_guis(srv, " #%d", player->id);
+    }
+    send_to_guis(srv, "\n");
+}
+
+void feed_incantation_end(server_t *srv, const feed_t *feed, const char *)
+{
+    send_to_guis(srv, "pie %hhu %hhu %hhu\n", feed->x, feed->y, feed->tier);
+}
+
+void feed_game_end(server_t *srv, const feed_t *feed, const char *)
+{
+    send_to_guis(srv, "seg %s\n", srv->team_names[feed->index]);
+}
+
+/**
+ * The pins of a meal are formatted back to back, and each GUI is handed the
+ * whole chunk at once instead of one message per player.
+ */
+void feed_meals(server_t *srv, const feed_t *feed, const char *)
+{
+    char chunk[4096];
+    char *end = chunk;
+    const client_state_t *player;
+
+    for (size_t i = srv->cm.idx_of_players; i < srv->cm.count
+        && gui_audience(srv); i++) {
+        player = srv->cm.clients + i;
+        if (player->meal_phase != feed->index)
+            continue;
+        end = proto_pin(end, player->id,
+            (uint8_t []){ player->x, player->y }, &player->inv);
+        if ((size_t)(chunk + sizeof chunk - end) < PROTO_TILE_MSG_MAX_LEN) {
+            append_bytes_to_guis(srv, chunk, end - chunk);
+            end = chunk;
+        }
+    }
+    if (end != chunk)
+        append_bytes_to_guis(srv, chunk, end - chunk);
+}
@@ -0,0 +1,106 @@
+#define _GNU_SOURCE
+
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "spectator.h"
+
+/** With -G, the GUIs connect to an observer: a child forked from the
+simulation, starting from its copy-on-write view of the world, then kept up
+to date by the records of the ring. The simulation never formats a GUI
+message nor writes to a GUI socket. An observer that falls behind by a whole
+ring, or dies, is replaced by a fresh fork: its GUIs get disconnected, and
+reconnect to the new one. **/
+
+static
+void observer_kill(spectator_t *spec)
+{
+    if (spec->observer <= 0)
+        return;
+    kill(spec->observer, SIGKILL);
+    waitpid(spec->observer, nullptr, 0);
+    spec->observer = 0;
+}
+
+static
+bool observer_fork(server_t *srv, spectator_t *spec)
+{
+    pid_t parent = getpid();
+    pid_t pid;
+
+    atomic_store(&spec->ring->head, 0);
+    atomic_store(&spec->ring->tail, 0);
+    atomic_store(&spec->ring->frequency, -1);
+    spec->pending = 0;
+    spec->overflowed = false;
+    pid = fork();
+    if (pid == 0)
+        spectator_observe(srv, spec, parent);
+    if (pid < 0)
+        return perror("Can't fork the spectator"), false;
+    spec->observer = pid;
+    DEBUG("Spectator forked, pid %d", pid);
+    return true;
+}
+
+bool spectator_start(server_t *srv, const params_t *p)
+{
+    spectator_t *spec;
+
+    if (p->spectator_port == 0)
+        return true;
+    spec = calloc(1, sizeof *spec);
+    if (spec == nullptr)
+        return perror("Can't allocate the spectator"), false;
+    srv->spectator = spec;
+    spec->listen_fd = server_socket_listen(p->spectator_port,
+        p->reuseport, p->backlog);
+    spec->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    spec->ring = spectator_ring_create();
+    if (spec->listen_fd < 0 || spec->event_fd < 0 || spec->ring == nullptr)
+        return perror("Can't set the spectator up"), false;
+    return observer_fork(srv, spec);
+}
+
+void spectator_sync(server_t *srv)
+{
+    spectator_t *spec = srv->spectator;
+    int32_t frequency;
+
+    if (spec == nullptr)
+        return;
+    frequency = atomic_exchange(&spec->ring->frequency, -1);
+    if (frequency >= 0)
+        server_set_frequency(srv, frequency);
+    if (LIKELY(!spec->overflowed)) {
+        spectator_ring_publish(spec);
+        return;
+    }
+    fprintf(stderr, "WARNING: Spectator fell behind, respawning it\n");
+    srv->metrics->spectator_respawns++;
+    observer_kill(spec);
+    observer_fork(srv, spec);
+}
+
+void spectator_stop(server_t *srv)
+{
+    spectator_t *spec = srv->spectator;
+
+    if (spec == nullptr)
+        return;
+    observer_kill(spec);
+    if (spec->ring != nullptr)
+        munmap(spec->ring, sizeof *spec->ring);
+    if (spec->listen_fd >= 0)
+        close(spec->listen_fd);
+    if (spec->event_fd >= 0)
+        close(spec->event_fd);
+    free(spec);
+    srv->spectator = nullptr;
+}
@@ -0,0 +1,203 @@
+#ifndef SPECTATOR_H_
+    #define SPECTATOR_H_
+
+    #include <stdatomic.h>
+    #include <stdbool.h>
+    #include <stddef.h>
+    #include <stdint.h>
+    #include <sys/types.h>
+
+    #include "client/client.h"
+    #include "server.h"
+
+/**
+ * @brief Kinds of state change the simulation reports to the GUIs.
+ *
+ * Each one is formatted into the GUI protocol message it replaces, except
+ * FEED_TILE, which only keeps the observer's copy of the map up to date.
+ */
+typedef enum {
+    FEED_PLAYER_JOIN, // pnw, pin and ebo of a player hatching from an egg
+    FEED_PLAYER_GONE, // pdi
+    FEED_POSITION, // ppo
+    FEED_INVENTORY, // pin
+    FEED_LEVEL, // plv
+    FEED_OBJECT, // pin then bct, after an object was taken or set
+    FEED_EXPULSION, // pex then ppo
+    FEED_BROADCAST, // pbc, the message following the record
+    FEED_FORK, // pfk
+    FEED_EGG_LAID, // enw
+    FEED_EGG_GONE, // edi
+    FEED_INCANTATION, // pic
+    FEED_INCANTATION_END, // pie
+    FEED_GAME_END, // seg
+    FEED_MEALS, // pin of every player of the meal phase index
+    FEED_TILE,
+
+    FEED_TYPE_COUNT
+} feed_type_t;
+
+/**
+ * @brief A state change, holding what its GUI message and the observer need.
+ * Fields a kind does not use are left zeroed.
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t x;
+    uint8_t y;
+    uint8_t orientation;
+    uint8_t tier;
+    uint8_t team_id;
+    uint8_t meal_phase;
+    uint16_t length; // Bytes of text following the record in the ring
+    uint32_t id; // Player id, or egg id
+    uint32_t index; // Egg index, team index for FEED_GAME_END, or meal phase
+    inventory_t inv; // Player inventory
+    inventory_t tile; // Content of the tile at x, y
+} feed_t;
+
+/**
+ * @brief Builds a state change carrying the whole state of a player.
+ *
+ * @param type
+ * @param cs
+ * @return feed_t
+ */
+static inline
+feed_t feed_of_player(uint8_t type, const client_state_t *cs)
+{
+    return (feed_t){ .type = type, .x = cs->x, .y = cs->y,
+        .orientation = cs->orientation, .tier = cs->tier,
+        .team_id = cs->team_id, .meal_phase = cs->meal_phase, .id = cs->id,
+        .inv = cs->inv };
+}
+
+/**
+ * @brief Size of the feed ring; past it, the observer is respawned.
+ *
+ */
+static constexpr const size_t SPECTATOR_RING_SIZE = 4 << 20;
+
+/**
+ * @brief Single producer, single consumer ring shared by the simulation and
+ * the observer. Records are 8 bytes aligned and may wrap around.
+ */
+typedef struct {
+    _Atomic uint64_t head; // Bytes ever published by the simulation
+    _Atomic uint64_t tail; // Bytes ever consumed by the observer
+    _Atomic int32_t frequency; // Set by the observer on sst, -1 otherwise
+    char data[SPECTATOR_RING_SIZE];
+} spectator_ring_t;
+
+/**
+ * @brief Simulation side of the spectator: the ring, the eventfd waking the
+ * observer up, and the port the GUIs connect to.
+ */
+typedef struct spectator_s {
+    spectator_ring_t *ring;
+    uint64_t pending; // Head once the records of this loop are published
+    bool overflowed;
+    int event_fd;
+    int listen_fd;
+    pid_t observer;
+} spectator_t;
+
+/**
+ * @brief Reports a state change to the GUIs: queued for the observer when
+ * there is one, formatted right away otherwise.
+ *
+ * @param srv
+ * @param feed
+ * @param text NUL-terminated payload, or nullptr
+ */
+void gui_feed(server_t *srv, const feed_t *feed, const char *text);
+/**
+ * @brief Reports a state change carrying the whole state of a player.
+ *
+ * @param srv
+ * @param type
+ * @param cs
+ */
+void gui_feed_player(server_t *srv, uint8_t type, const client_state_t *cs);
+/**
+ * @brief Sends the GUI message of a state change to the connected GUIs.
+ *
+ * @param srv
+ * @param feed
+ * @param text
+ */
+void feed_format(server_t *srv, const feed_t *feed, const char *text);
+/**
+ * @brief Applies a state change to the observer's copy of the world, then
+ * sends its GUI message.
+ *
+ * @param srv
+ * @param feed
+ * @param text
+ */
+void feed_apply(server_t *srv, const feed_t *feed, const char *text);
+
+/**
+ * @brief Maps the ring in memory shared with the children to come.
+ *
+ * @return spectator_ring_t* The ring, or nullptr if mmap failed.
+ */
+spectator_ring_t *spectator_ring_create(void);
+/**
+ * @brief Queues a record, published at the end of the loop.
+ *
+ * @param spec
+ * @param feed Record whose length matches the text.
+ * @param text
+ * @return false if the ring is full
+ */
+bool spectator_ring_push(spectator_t *spec, const feed_t *feed,
+    const char *text);
+/**
+ * @brief Makes the queued records visible to the observer and wakes it up.
+ *
+ * @param spec
+ */
+void spectator_ring_publish(spectator_t *spec);
+/**
+ * @brief Applies every published record, then frees their room.
+ *
+ * @param srv Observer's server
+ * @param ring
+ * @return size_t Number of bytes consumed.
+ */
+size_t spectator_ring_drain(server_t *srv, spectator_ring_t *ring);
+
+/**
+ * @brief Opens the GUI port and forks the observer, if -G was given.
+ *
+ * @param srv
+ * @param p
+ * @return false if the port or the ring could not be set up
+ */
+bool spectator_start(server_t *srv, const params_t *p);
+/**
+ * @brief Publishes the records of the loop, picks up a frequency changed by
+ * a GUI, and respawns the observer if it fell behind or died.
+ *
+ * @param srv
+ */
+void spectator_sync(server_t *srv);
+/**
+ * @brief Stops the observer and releases the spectator.
+ *
+ * @param srv
+ */
+void spectator_stop(server_t *srv);
+/**
+ * @brief Turns a freshly forked child into the observer, serves the GUIs
+ * until the simulation stops, then exits.
+ *
+ * @param srv Child's copy of the server
+ * @param spec
+ * @param parent Process of the simulation
+ */
+[[gnu::noreturn]]
+void spectator_observe(server_t *srv, spectator_t *spec, pid_t parent);
+
+#endif /* !SPECTATOR_H_ */
@@ -0,0 +1,105 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+
+#include "utils/buffer_pool.h"
+
+#include "spectator.h"
+
+/** The observer is the server it was forked from, stripped down to the GUI
+side: its event queue only ever holds the GUI commands, its players are
+bodies without a connection, and the port it accepts on is the GUI one. A
+single descriptor, an epoll set of that port and of the eventfd, sits in
+the server slot of the poll array, so that the regular poll round wakes up
+for both. **/
+
+// Ids of the observer's own clients, far from the ones of the players
+static constexpr const uint32_t OBSERVER_FIRST_CLIENT_ID = 1U << 30;
+
+static
+void detach_players(server_t *srv)
+{
+    client_state_t *player;
+
+    for (size_t i = srv->cm.idx_of_players; i < srv->cm.count; i++) {
+        player = srv->cm.clients + i;
+        if (player->fd >= 0)
+            close(player->fd);
+        player->fd = -1;
+        srv->cm.server_pfds[i].fd = -1;
+        buffer_pool_drop(&player->input);
+        buffer_pool_drop(&player->output);
+        player->in_buff_idx = 0;
+        player->in_scan_idx = 0;
+        player->out_buff_idx = 0;
+        player->out_since = 0;
+    }
+}
+
+static
+bool observer_adopt(server_t *srv, spectator_t *spec)
+{
+    int epoll_fd;
+
+    srv->journal = nullptr;
+    srv->snapshot = (snapshot_schedule_t){ };
+    srv->spectator = nullptr;
+    srv->is_observer = true;
+    srv->next_client_id = OBSERVER_FIRST_CLIENT_ID;
+    event_queue_free(&srv->events);
+    server_close_listeners(srv);
+    srv->self_fd = spec->listen_fd;
+    srv->cm.clients[0].fd = spec->listen_fd;
+    while (srv->cm.idx_of_players > 1)
+        remove_client(srv, 1);
+    detach_players(srv);
+    epoll_fd = server_socket_watch(spec->listen_fd, spec->event_fd);
+    if (epoll_fd < 0)
+        return perror("Can't set the spectator up"), false;
+    srv->cm.server_pfds[0] = (struct pollfd){ .fd = epoll_fd,
+        .events = POLLIN };
+    return true;
+}
+
+static
+int32_t observer_timeout(server_t *srv)
+{
+    int32_t timeout;
+
+    if (event_queue_depth(&srv->events) == 0)
+        return -1;
+    timeout = compute_timeout(srv);
+    return timeout < 0 ? 0 : timeout;
+}
+
+static
+void observer_step(server_t *srv, spectator_t *spec)
+{
+    uint64_t wakeups;
+    uint16_t frequency = srv->frequency;
+
+    server_handle_events(srv);
+    server_poll_round(srv, observer_timeout(srv));
+    if (read(spec->event_fd, &wakeups, sizeof wakeups) < 0 && errno != EAGAIN)
+        perror("Can't read the spectator wakeups");
+    spectator_ring_drain(srv, spec->ring);
+    if (srv->frequency != frequency)
+        atomic_store(&spec->ring->frequency, srv->frequency);
+}
+
+void spectator_observe(server_t *srv, spectator_t *spec, pid_t parent)
+{
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    if (getppid() != parent || !observer_adopt(srv, spec))
+        _exit(EXIT_FAILURE);
+    while (srv->is_running)
+        observer_step(srv, spec);
+    _exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,112 @@
+#define _GNU_SOURCE
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "spectator.h"
+
+/** The simulation is the only writer of head, the observer the only writer
+of tail, both counting bytes since the ring was reset. Records queued during
+a loop are published at once, with a single release store and a single
+wakeup, so the observer never sees a record before its bytes are written. **/
+
+static constexpr const size_t FEED_ALIGN = 8;
+
+static
+size_t record_size(const feed_t *feed)
+{
+    return (sizeof *feed + feed->length + FEED_ALIGN - 1)
+        & ~(FEED_ALIGN - 1);
+}
+
+static
+void ring_write(spectator_ring_t *ring, uint64_t at, const void *src,
+    size_t size)
+{
+    size_t offset = at % SPECTATOR_RING_SIZE;
+    size_t first = SPECTATOR_RING_SIZE - offset;
+
+    if (first > size)
+        first = size;
+    memcpy(ring->data + offset, src, first);
+    memcpy(ring->data, (const char *)src + first, size - first);
+}
+
+static
+void ring_read(const spectator_ring_t *ring, uint64_t at, void *dest,
+    size_t size)
+{
+    size_t offset = at % SPECTATOR_RING_SIZE;
+    size_t first = SPECTATOR_RING_SIZE - offset;
+
+    if (first > size)
+        first = size;
+    memcpy(dest, ring->data + offset, first);
+    memcpy((char *)dest + first, ring->data, size - first);
+}
+
+spectator_ring_t *spectator_ring_create(void)
+{
+    spectator_ring_t *ring = mmap(nullptr, sizeof *ring,
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (ring == MAP_FAILED)
+        return nullptr;
+    atomic_init(&ring->frequency, -1);
+    return ring;
+}
+
+bool spectator_ring_push(spectator_t *spec, const feed_t *feed,
+    const char *text)
+{
+    spectator_ring_t *ring = spec->ring;
+    size_t size = record_size(feed);
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (spec->overflowed)
+        return false;
+    if (spec->pending + size - tail > SPECTATOR_RING_SIZE) {
+        spec->overflowed = true;
+        return false;
+    }
+    ring_write(ring, spec->pending, feed, sizeof *feed);
+    if (feed->length > 0)
+        ring_write(ring, spec->pending + sizeof *feed, text, feed->length);
+    spec->pending += size;
+    return true;
+}
+
+void spectator_ring_publish(spectator_t *spec)
+{
+    uint64_t one = 1;
+
+    if (spec->pending == atomic_load_explicit(&spec->ring->head,
+        memory_order_relaxed))
+        return;
+    atomic_store_explicit(&spec->ring->head, spec->pending,
+        memory_order_release);
+    if (write(spec->event_fd, &one, sizeof one) < 0)
+        perror("Can't wake the spectator up");
+}
+
+size_t spectator_ring_drain(server_t *srv, spectator_ring_t *ring)
+{
+    static char text[UINT16_MAX + 1];
+    uint64_t start = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint64_t tail = start;
+    feed_t feed;
+
+    while (tail < head) {
+        ring_read(ring, tail, &feed, sizeof feed);
+        ring_read(ring, tail + sizeof feed, text, feed.length);
+        text[feed.length] = '\0';
+        feed_apply(srv, &feed, feed.length == 0 ? nullptr : text);
+        tail += record_size(&feed);
+    }
+    atomic_store_explicit(&ring->tail, tail, memory_order_release);
+    return tail - start;
+}
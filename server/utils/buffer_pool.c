@@ -0,0 +1,177 @@
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "buffer_pool.h"
+#include "debug.h"
+
+/** Buffers come in power of two size classes, from 64 B to 64 KiB.
+
+Classes up to SLAB_CLASS_MAX are carved out of 64 KiB slabs which are only
+given back on purge; bigger ones are allocated one by one, and at most
+LARGE_CACHE_LIMIT of them are kept around per class. Past the last class,
+buffers bypass the pool. Freed buffers hold the free list link in their
+first bytes. Each thread has its own pool, so the matches of a hosting
+server never contend for it. **/
+
+static constexpr const size_t POOL_MIN_SHIFT = 6;
+static constexpr const size_t POOL_CLASS_COUNT = 11;
+static constexpr const size_t SLAB_SIZE = 65536;
+static constexpr const size_t SLAB_CLASS_MAX = 4096;
+static constexpr const size_t LARGE_CACHE_LIMIT = 32;
+
+struct free_node_s {
+    struct free_node_s *next;
+};
+
+typedef struct {
+    char **buff;
+    size_t nmemb;
+    size_t capacity;
+} slab_array_t;
+
+static thread_local struct {
+    struct free_node_s *free[POOL_CLASS_COUNT];
+    size_t free_count[POOL_CLASS_COUNT];
+    slab_array_t slabs;
+    buffer_pool_stats_t stats;
+} POOL = { };
+
+static
+size_t size_class(size_t size)
+{
+    if (size <= ((size_t)1 << POOL_MIN_SHIFT))
+        return 0;
+    return (CHAR_BIT * sizeof(size_t)) - __builtin_clzl(size - 1)
+        - POOL_MIN_SHIFT;
+}
+
+static
+void pool_push(size_t cls, char *buff)
+{
+    struct free_node_s *node = (struct free_node_s *)(void *)buff;
+
+    node->next = POOL.free[cls];
+    POOL.free[cls] = node;
+    POOL.free_count[cls]++;
+    POOL.stats.cached += (size_t)1 << (cls + POOL_MIN_SHIFT);
+}
+
+static
+bool pool_refill(size_t cls)
+{
+    size_t size = (size_t)1 << (cls + POOL_MIN_SHIFT);
+    size_t chunk = (size <= SLAB_CLASS_MAX) ? SLAB_SIZE : size;
+    char *mem = malloc(chunk);
+
+    if (mem == nullptr)
+        return false;
+    if (size <= SLAB_CLASS_MAX) {
+        if (!sized_struct_ensure_capacity((resizable_array_t *)&POOL.slabs,
+            1, sizeof *POOL.slabs.buff))
+            return free(mem), false;
+        POOL.slabs.buff[POOL.slabs.nmemb] = mem;
+        POOL.slabs.nmemb++;
+    }
+    for (size_t off = 0; off < chunk; off += size)
+        pool_push(cls, mem + off);
+    POOL.stats.resident += chunk;
+    DEBUG("Buffer pool refilled class %zu with %zu bytes", size, chunk);
+    return true;
+}
+
+static
+char *pool_pop(size_t cls)
+{
+    struct free_node_s *node;
+
+    if (cls >= POOL_CLASS_COUNT) {
+        POOL.stats.misses++;
+        return malloc((size_t)1 << (cls + POOL_MIN_SHIFT));
+    }
+    POOL.stats.hits += POOL.free[cls] != nullptr;
+    POOL.stats.misses += POOL.free[cls] == nullptr;
+    if (POOL.free[cls] == nullptr && !pool_refill(cls))
+        return nullptr;
+    node = POOL.free[cls];
+    POOL.free[cls] = node->next;
+    POOL.free_count[cls]--;
+    POOL.stats.cached -= (size_t)1 << (cls + POOL_MIN_SHIFT);
+    return (char *)node;
+}
+
+static
+void pool_release(char *buff, size_t capacity)
+{
+    size_t cls = size_class(capacity);
+
+    if (cls >= POOL_CLASS_COUNT) {
+        free(buff);
+        return;
+    }
+    if (capacity > SLAB_CLASS_MAX
+        && POOL.free_count[cls] >= LARGE_CACHE_LIMIT) {
+        free(buff);
+        POOL.stats.resident -= capacity;
+        return;
+    }
+    pool_push(cls, buff);
+}
+
+bool buffer_pool_reserve(resizable_array_t *arr, size_t requested)
+{
+    size_t needed = arr->nmemb + requested;
+    size_t cls = size_class(needed);
+    char *newp;
+
+    if (arr->buff != nullptr && needed <= arr->capacity)
+        return true;
+    newp = pool_pop(cls);
+    if (newp == nullptr)
+        return false;
+    if (arr->buff != nullptr) {
+        memcpy(newp, arr->buff, arr->nmemb);
+        pool_release(arr->buff, arr->capacity);
+    }
+    arr->buff = newp;
+    arr->capacity = (size_t)1 << (cls + POOL_MIN_SHIFT);
+    return true;
+}
+
+void buffer_pool_drop(resizable_array_t *arr)
+{
+    if (arr->buff != nullptr)
+        pool_release(arr->buff, arr->capacity);
+    arr->buff = nullptr;
+    arr->nmemb = 0;
+    arr->capacity = 0;
+}
+
+const buffer_pool_stats_t *buffer_pool_stats(void)
+{
+    return &POOL.stats;
+}
+
+void buffer_pool_prefault(void)
+{
+    for (size_t cls = 0; cls <= size_class(SLAB_CLASS_MAX); cls++)
+        if (POOL.free[cls] == nullptr)
+            pool_refill(cls);
+}
+
+void buffer_pool_purge(void)
+{
+    struct free_node_s *next;
+
+    for (size_t cls = size_class(SLAB_CLASS_MAX) + 1;
+        cls < POOL_CLASS_COUNT; cls++) {
+        for (struct free_node_s *n = POOL.free[cls]; n != nullptr; n = next) {
+            next = n->next;
+            free(n);
+        }
+    }
+    for (size_t i = 0; i < POOL.slabs.nmemb; i++)
+        free(POOL.slabs.buff[i]);
+    free(POOL.slabs.buff);
+    memset(&POOL, 0, sizeof POOL);
+}
@@ -0,0 +1,57 @@
+#ifndef BUFFER_POOL_H_
+    #define BUFFER_POOL_H_
+
+    #include <stddef.h>
+    #include <stdint.h>
+
+    #include "resizable_array.h"
+
+/**
+ * @brief Counters describing how the buffer pool is being used.
+ *
+ */
+typedef struct {
+    uint64_t hits; // Requests served from a free list
+    uint64_t misses; // Requests that needed fresh memory
+    size_t resident; // Bytes obtained by the pool, in use or cached
+    size_t cached; // Bytes sitting in the free lists
+} buffer_pool_stats_t;
+
+/**
+ * @brief Ensures the byte array can hold `requested` more bytes, moving it
+ * to a buffer of the next size class when it can't.
+ *
+ * Client I/O buffers must only be grown through this function and given
+ * back with buffer_pool_drop, so they get recycled across connections.
+ *
+ * @param arr
+ * @param requested
+ * @return true
+ * @return false if the allocation failed, arr being left untouched
+ */
+bool buffer_pool_reserve(resizable_array_t *arr, size_t requested);
+/**
+ * @brief Gives the array's buffer back to the pool and resets it.
+ *
+ * @param arr
+ */
+void buffer_pool_drop(resizable_array_t *arr);
+/**
+ * @brief Returns the pool counters.
+ *
+ * @return const buffer_pool_stats_t*
+ */
+const buffer_pool_stats_t *buffer_pool_stats(void);
+/**
+ * @brief Releases every cached buffer and slab back to the system.
+ *
+ * Buffers still in use when this is called must not be dropped afterwards.
+ */
+void buffer_pool_purge(void);
+/**
+ * @brief Fills every slab class of the pool once, so that the first clients
+ * neither allocate nor fault pages in.
+ */
+void buffer_pool_prefault(void);
+
+#endif /* !BUFFER_POOL_H_ */
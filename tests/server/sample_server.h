@@ -0,0 +1,62 @@
+#ifndef SAMPLE_SERVER_H_
+    #define SAMPLE_SERVER_H_
+
+    #include <stdio.h>
+    #include <string.h>
+
+    #include "client/client.h"
+    #include "server.h"
+
+/** The world the server tests start from: a 10x12 map generated from seed
+7, two teams of three players, and the default output limits. **/
+
+static char *SAMPLE_TEAMS[] = {
+    "-SERVER", "-UNASSIGNED", "GRAPHIC", "red", "blue", nullptr
+};
+
+static inline
+params_t sample_params(void)
+{
+    return (params_t){ .teams = SAMPLE_TEAMS, .registered_team_count = 5,
+        .frequency = 100, .map_width = 10, .map_height = 12,
+        .team_capacity = 3, .seed = 7,
+        .out_high_kib = 1024, .out_low_kib = 256, .out_stall_sec = 10 };
+}
+
+/**
+ * @brief Builds the sample world, without opening any socket.
+ *
+ * @param srv Zeroed server, with self_fd set to -1
+ * @return false if server_start failed
+ */
+static inline
+bool start_sample(server_t *srv)
+{
+    params_t p = sample_params();
+
+    return server_start(srv, &p);
+}
+
+/**
+ * @brief Connects a client without a socket and answers the WELCOME with
+ * the given line. The WELCOME is dropped, so the output of the client
+ * only holds the replies to that line.
+ *
+ * @param team Team name, or GRAPHIC and its options
+ * @return the client where it lives once the line is handled, nullptr if
+ * it was disconnected
+ */
+static inline
+client_state_t *join_sample_team(server_t *srv, const char *team)
+{
+    client_state_t *client = add_client_state(srv, -1);
+    uint32_t id = client->id;
+    char line[64];
+
+    snprintf(line, sizeof line, "%s", team);
+    client->output.nmemb = 0;
+    client_process_line(srv, client, line, strlen(line));
+    return client_from_id(srv, id);
+}
+
+#endif /* !SAMPLE_SERVER_H_ */
@@ -0,0 +1,51 @@
+#include <string.h>
+
+#include "utils/buffer_pool.h"
+
+#include "compass.h"
+
+Test(buffer_pool, rounds_to_size_class)
+{
+    resizable_array_t arr = { };
+
+    assert("reserve succeeds", buffer_pool_reserve(&arr, 100));
+    assert("rounded to the next class", arr.capacity == 128);
+    arr.nmemb = 100;
+    memset(arr.buff, 'x', arr.nmemb);
+    assert("grows", buffer_pool_reserve(&arr, 1000));
+    assert("next class holds everything", arr.capacity == 2048);
+    assert("content is kept", arr.buff[0] == 'x' && arr.buff[99] == 'x');
+    buffer_pool_drop(&arr);
+    assert("array is reset", arr.buff == nullptr && arr.capacity == 0);
+    buffer_pool_purge();
+}
+
+Test(buffer_pool, recycles_dropped_buffers)
+{
+    resizable_array_t arr = { };
+    char *first;
+
+    buffer_pool_reserve(&arr, 1024);
+    first = arr.buff;
+    buffer_pool_drop(&arr);
+    buffer_pool_reserve(&arr, 1024);
+    assert("same buffer handed back", arr.buff == first);
+    assert("second request is a hit", buffer_pool_stats()->hits == 1);
+    assert("first request is a miss", buffer_pool_stats()->misses == 1);
+    buffer_pool_drop(&arr);
+    assert("slab stays resident", buffer_pool_stats()->resident == 65536);
+    assert("everything is cached", buffer_pool_stats()->cached == 65536);
+    buffer_pool_purge();
+    assert("purge resets the pool", buffer_pool_stats()->resident == 0);
+}
+
+Test(buffer_pool, bypasses_pool_for_huge_buffers)
+{
+    resizable_array_t arr = { };
+
+    assert("reserve succeeds", buffer_pool_reserve(&arr, 1 << 20));
+    assert("power of two capacity", arr.capacity == 1 << 20);
+    assert("not held by the pool", buffer_pool_stats()->resident == 0);
+    buffer_pool_drop(&arr);
+    assert("not cached either", buffer_pool_stats()->cached == 0);
+}
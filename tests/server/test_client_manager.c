@@ -52,11 +52,13 @@ client_manager_t *client_manager_from_counts(struct counts counts)
     static client_manager_t cm = { };
     static struct pollfd pfds[64];
     static client_state_t clients[64];
+    static uint32_t dirty[64];
 
     memset(&cm, 0, sizeof cm);
     memset(clients, 0, sizeof clients);
     cm.clients = clients;
     cm.server_pfds = pfds;
+    cm.dirty = dirty;
 
     for (size_t i = 0; i < 64; i++)
         cm.server_pfds[i].fd = cm.clients[i].fd = i;
@@ -181,3 +183,34 @@ Test(client_manager, batch_test)
             assert("is the correct fd", c.fds[j] == cm->clients[j].fd);
     }
 }
+
+static
+bool dirty_list_holds(client_manager_t *cm, const int *fds, size_t count)
+{
+    if (cm->dirty_count != count)
+        return false;
+    for (size_t i = 0; i < count; i++)
+        if (cm->clients[cm->dirty[i]].fd != fds[i]
+            || cm->clients[cm->dirty[i]].dirty_slot != i + 1)
+            return false;
+    return true;
+}
+
+Test(client_manager, dirty_list_follows_swaps)
+{
+    client_manager_t *cm = client_manager_from_counts(
+        (struct counts){ 1, 1, 2 });
+
+    client_manager_mark_dirty(cm, 4);
+    client_manager_mark_dirty(cm, 1);
+    client_manager_mark_dirty(cm, 1);
+    assert("listed once", dirty_list_holds(cm, (int []){ 4, 1 }, 2));
+    client_manager_remove(cm, 2);
+    assert("moved along", dirty_list_holds(cm, (int []){ 4, 1 }, 2));
+    client_manager_add(cm);
+    assert("still found", dirty_list_holds(cm, (int []){ 4, 1 }, 2));
+    client_manager_remove(cm, cm->dirty[0]);
+    assert("removed ones unlisted", dirty_list_holds(cm, (int []){ 1 }, 1));
+    client_manager_clear_dirty(cm, cm->dirty[0]);
+    assert("cleared", cm->dirty_count == 0);
+}
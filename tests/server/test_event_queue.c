@@ -0,0 +1,67 @@
+#include "event.h"
+
+#include "compass.h"
+
+static
+int fire_next(event_queue_t *queue)
+{
+    event_lane_t lane;
+    const event_t *event = event_queue_peek(queue, &lane);
+    int id = event == nullptr ? -1 : event->client_id;
+
+    event_queue_pop(queue, lane);
+    return id;
+}
+
+Test(event_queue, gui_queries_skip_due_actions)
+{
+    event_queue_t queue;
+    event_t action = { .timestamp = 5, .client_idx = 3, .client_id = 1,
+        .command = { "Look" } };
+    event_t query = { .timestamp = 10, .client_idx = 2, .client_id = 2,
+        .command = { "mct" } };
+
+    event_queue_init(&queue);
+    for (int i = 0; i < 1000; i++)
+        event_queue_push(&queue, &action, LANE_ACTION);
+    event_queue_push(&queue, &query, LANE_GUI);
+    assert("query first", fire_next(&queue) == 2);
+    assert("then the actions", fire_next(&queue) == 1
+        && event_queue_depth(&queue) == 999);
+    event_queue_free(&queue);
+}
+
+Test(event_queue, timers_and_actions_share_deadlines)
+{
+    event_queue_t queue;
+    event_t event = { .timestamp = 10, .client_id = 1, .command = { "-" } };
+    static const int order[] = { 2, 3, 1, 4 };
+
+    event_queue_init(&queue);
+    event_queue_push(&queue, &event, LANE_ACTION);
+    event = (event_t){ .timestamp = 5, .client_id = 2, .command = { "-" } };
+    event_queue_push(&queue, &event, LANE_TIMER);
+    event.client_id = 3;
+    event_queue_push(&queue, &event, LANE_ACTION);
+    event = (event_t){ .timestamp = 10, .client_id = 4, .command = { "-" } };
+    event_queue_push(&queue, &event, LANE_TIMER);
+    for (size_t i = 0; i < 4; i++)
+        assert("deadline then push order", fire_next(&queue) == order[i]);
+    assert("empty", event_queue_depth(&queue) == 0);
+    event_queue_free(&queue);
+}
+
+Test(event_queue, forget_reaches_every_lane)
+{
+    event_queue_t queue;
+    event_t event = { .client_idx = 4, .client_id = 7, .command = { "-" } };
+
+    event_queue_init(&queue);
+    for (event_lane_t lane = 0; lane < LANE_COUNT; lane++)
+        event_queue_push(&queue, &event, lane);
+    event_queue_forget(&queue, 7);
+    assert("gui dead", queue.gui.buff[0].client_idx == CLIENT_DEAD);
+    assert("action dead", queue.actions.buff[0].client_idx == CLIENT_DEAD);
+    assert("timer dead", queue.timers.buff[0].client_idx == CLIENT_DEAD);
+    event_queue_free(&queue);
+}
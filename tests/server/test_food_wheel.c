@@ -0,0 +1,82 @@
+#define _GNU_SOURCE
+
+#include <string.h>
+
+#include "client/client.h"
+#include "game_events/handler.h"
+#include "game_events/names.h"
+#include "server.h"
+
+#include "compass.h"
+#include "sample_server.h"
+
+static
+bool start_players(server_t *srv, size_t players)
+{
+    SERVER_CLOCK = (server_clock_t){ .is_virtual = true, .now = 1000000 };
+    if (!start_sample(srv))
+        return false;
+    for (size_t i = 0; i < players; i++)
+        join_sample_team(srv, "red");
+    return srv->cm.count - srv->cm.idx_of_players == players;
+}
+
+static
+void sweep(server_t *srv)
+{
+    event_t event = { .timestamp = srv->food.due_tick * GAME_TIME_UNIT,
+        .command = { PLAYER_DEATH } };
+
+    SERVER_CLOCK.now = wall_time_of(srv, event.timestamp);
+    player_death_handler(srv, &event);
+}
+
+Test(food_wheel, one_sweep_feeds_a_phase)
+{
+    server_t srv = { .self_fd = -1 };
+    uint64_t first;
+
+    assert("players joined", start_players(&srv, 3));
+    assert("a single sweep queued", srv.events.timers.nmemb == 2
+        && srv.food.bucket[srv.cm.clients[srv.cm.count - 1].meal_phase]
+            == 3);
+    first = srv.food.due_tick;
+    sweep(&srv);
+    for (size_t i = srv.cm.idx_of_players; i < srv.cm.count; i++)
+        assert("fed", srv.cm.clients[i].inv.food == 9);
+    assert("next meal a period later",
+        srv.food.due_tick == first + FOOD_PERIOD);
+    server_destroy(&srv);
+    SERVER_CLOCK = (server_clock_t){ };
+}
+
+Test(food_wheel, starving_players_die)
+{
+    server_t srv = { .self_fd = -1 };
+    uint8_t phase;
+
+    assert("players joined", start_players(&srv, 3));
+    phase = srv.cm.clients[srv.cm.idx_of_players].meal_phase;
+    srv.cm.clients[srv.cm.idx_of_players].inv.food = 0;
+    sweep(&srv);
+    assert("starved", srv.cm.count - srv.cm.idx_of_players == 2
+        && srv.food.bucket[phase] == 2);
+    for (size_t i = srv.cm.idx_of_players; i < srv.cm.count; i++)
+        assert("others fed", srv.cm.clients[i].inv.food == 9);
+    server_destroy(&srv);
+    SERVER_CLOCK = (server_clock_t){ };
+}
+
+Test(food_wheel, stale_sweeps_do_nothing)
+{
+    server_t srv = { .self_fd = -1 };
+    event_t stale = { .command = { PLAYER_DEATH } };
+
+    assert("players joined", start_players(&srv, 2));
+    stale.timestamp = srv.food.due_tick * GAME_TIME_UNIT + 1;
+    player_death_handler(&srv, &stale);
+    for (size_t i = srv.cm.idx_of_players; i < srv.cm.count; i++)
+        assert("not fed", srv.cm.clients[i].inv.food == 10);
+    server_destroy(&srv);
+    SERVER_CLOCK = (server_clock_t){ };
+}
@@ -0,0 +1,45 @@
+#include "server.h"
+
+#include "compass.h"
+#include "sample_server.h"
+
+static
+bool start_virtual(server_t *srv)
+{
+    SERVER_CLOCK = (server_clock_t){ .is_virtual = true, .now = 1000000 };
+    return start_sample(srv);
+}
+
+Test(game_clock, frequency_change_rescales_deadlines)
+{
+    server_t srv = { .self_fd = -1 };
+    uint64_t deadline;
+
+    assert("world started", start_virtual(&srv));
+    SERVER_CLOCK.now += 500000;
+    deadline = game_now(&srv) + 100 * GAME_TIME_UNIT;
+    assert("a second away at 100",
+        wall_time_of(&srv, deadline) - SERVER_CLOCK.now == 1000000);
+    server_set_frequency(&srv, 2000);
+    assert("50 ms away at 2000",
+        wall_time_of(&srv, deadline) - SERVER_CLOCK.now == 50000);
+    SERVER_CLOCK.now += 50000;
+    assert("due then", game_now(&srv) == deadline);
+    server_destroy(&srv);
+    SERVER_CLOCK = (server_clock_t){ };
+}
+
+Test(game_clock, zero_frequency_pauses)
+{
+    server_t srv = { .self_fd = -1 };
+    uint64_t before;
+
+    assert("world started", start_virtual(&srv));
+    server_set_frequency(&srv, 0);
+    before = game_now(&srv);
+    SERVER_CLOCK.now += 5000000;
+    assert("game time stood still", game_now(&srv) == before);
+    assert("nothing comes due", wall_time_of(&srv, before + 1) == UINT64_MAX);
+    server_destroy(&srv);
+    SERVER_CLOCK = (server_clock_t){ };
+}
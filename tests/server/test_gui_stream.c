@@ -0,0 +1,115 @@
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "client/client.h"
+#include "server.h"
+
+#include "compass.h"
+#include "sample_server.h"
+
+Test(gui_stream, record_wraps_around)
+{
+    gui_stream_t stream = { .data = malloc(GUI_STREAM_SIZE),
+        .head = 3 * GUI_STREAM_SIZE - 3 };
+
+    gui_stream_record(&stream, "abcdef", 6);
+    assert("head moved", stream.head == 3 * GUI_STREAM_SIZE + 3);
+    assert("tail of the ring", !memcmp(stream.data + GUI_STREAM_SIZE - 3,
+        "abc", 3));
+    assert("front of the ring", !memcmp(stream.data, "def", 3));
+    free(stream.data);
+}
+
+Test(gui_stream, resume_sends_only_missed_messages)
+{
+    server_t srv = { .self_fd = -1 };
+    client_state_t *gui;
+    uint64_t seq;
+    char expected[256];
+
+    assert("server started", start_sample(&srv));
+    gui = join_sample_team(&srv, "GRAPHIC 0");
+    assert("snapshot sent", gui != nullptr
+        && !strncmp(gui->output.buff, "msz 10 12\n", 10)
+        && strstr(gui->output.buff, "seq 0\n") != nullptr);
+    join_sample_team(&srv, "red");
+    seq = srv.gui_stream.head;
+    assert("join recorded", seq != 0);
+    remove_client(&srv, srv.cm.idx_of_gui);
+    join_sample_team(&srv, "blue");
+    gui = join_sample_team(&srv, "GRAPHIC 12x");
+    assert("sequence number checked", gui == nullptr
+        || gui->team_id == TEAM_ID_UNASSIGNED);
+    snprintf(expected, sizeof expected, "GRAPHIC %lu", seq);
+    gui = join_sample_team(&srv, expected);
+    snprintf(expected, sizeof expected, "seq %lu\n", srv.gui_stream.head);
+    assert("only the missed join", gui != nullptr
+        && !strncmp(gui->output.buff, "pnw #", 5)
+        && strstr(gui->output.buff, "msz") == nullptr
+        && strstr(gui->output.buff, expected) != nullptr);
+    assert("counted", srv.gui_stream.resumes == 1
+        && srv.gui_stream.snapshots == 1);
+    server_destroy(&srv);
+}
+
+Test(gui_stream, falls_back_to_snapshot_when_behind)
+{
+    server_t srv = { .self_fd = -1 };
+    client_state_t *gui;
+    char filler[4096];
+
+    assert("server started", start_sample(&srv));
+    join_sample_team(&srv, "GRAPHIC 0");
+    memset(filler, 'x', sizeof filler);
+    for (size_t i = 0; i <= GUI_STREAM_SIZE / sizeof filler; i++)
+        gui_stream_record(&srv.gui_stream, filler, sizeof filler);
+    gui = join_sample_team(&srv, "GRAPHIC 1");
+    assert("snapshot sent", gui != nullptr
+        && !strncmp(gui->output.buff, "msz 10 12\n", 10));
+    gui = join_sample_team(&srv, "GRAPHIC 99999999999");
+    assert("snapshot for a future seq", gui != nullptr
+        && !strncmp(gui->output.buff, "msz 10 12\n", 10));
+    server_destroy(&srv);
+}
+
+static
+size_t inflate_output(const client_state_t *gui, char *out, size_t size)
+{
+    z_stream z = { .next_in = (Bytef *)gui->output.buff,
+        .avail_in = gui->output.nmemb, .next_out = (Bytef *)out,
+        .avail_out = size - 1 };
+
+    inflateInit2(&z, -MAX_WBITS);
+    inflate(&z, Z_SYNC_FLUSH);
+    inflateEnd(&z);
+    out[size - 1 - z.avail_out] = '\0';
+    return size - 1 - z.avail_out;
+}
+
+Test(gui_stream, deflate_matches_plain_output)
+{
+    server_t srv = { .self_fd = -1 };
+    client_state_t *plain;
+    client_state_t *packed;
+    static char inflated[1 << 16];
+
+    assert("server started", start_sample(&srv));
+    assert("option checked", join_sample_team(&srv, "GRAPHIC 0 gzip")->team_id
+        == TEAM_ID_UNASSIGNED);
+    join_sample_team(&srv, "GRAPHIC 0");
+    join_sample_team(&srv, "GRAPHIC 0 deflate");
+    join_sample_team(&srv, "red");
+    flush_dirty_clients(&srv);
+    plain = srv.cm.clients + srv.cm.idx_of_gui;
+    packed = plain + 1;
+    if (plain->gui_compressed)
+        packed = plain++;
+    assert("one of each", packed->gui_compressed && !plain->gui_compressed);
+    assert("smaller", packed->output.nmemb < plain->output.nmemb);
+    inflate_output(packed, inflated, sizeof inflated);
+    assert("same messages", !strcmp(inflated, plain->output.buff));
+    assert("counted", srv.gui_stream.deflate_out == packed->output.nmemb
+        && srv.gui_stream.deflate_in == plain->output.nmemb);
+    server_destroy(&srv);
+}
@@ -0,0 +1,60 @@
+#include <string.h>
+
+#include "metrics/metrics.h"
+
+#include "compass.h"
+
+Test(histogram, small_values_are_exact)
+{
+    histogram_t hist = { };
+
+    for (uint64_t v = 0; v < 8; v++)
+        histogram_record(&hist, v);
+    assert("one bucket per small value", hist.buckets[0] == 1
+        && hist.buckets[7] == 1 && hist.buckets[8] == 0);
+    assert("bucket upper bound", histogram_bucket_upper(5) == 5);
+    assert("count is kept", hist.count == 8 && hist.sum == 28);
+    assert("max is kept", hist.max == 7);
+}
+
+Test(histogram, buckets_bound_relative_error)
+{
+    uint64_t upper;
+
+    assert("first log bucket", histogram_bucket_upper(8) == 8);
+    assert("second octave", histogram_bucket_upper(16) == 17);
+    for (size_t i = 8; i < HISTOGRAM_BUCKETS - 1; i++) {
+        upper = histogram_bucket_upper(i);
+        assert("buckets are ordered", upper < histogram_bucket_upper(i + 1));
+        assert("bucket width stays within 12.5%",
+            upper - histogram_bucket_upper(i - 1) <= upper / 8 + 1);
+    }
+}
+
+Test(histogram, count_le_sums_buckets)
+{
+    histogram_t hist = { };
+
+    histogram_record(&hist, 90);
+    histogram_record(&hist, 1000);
+    histogram_record(&hist, 30000);
+    histogram_record(&hist, UINT64_MAX);
+    assert("values below the bound",
+        histogram_count_le(&hist, 100) == 1);
+    assert("bound is inclusive of its bucket",
+        histogram_count_le(&hist, 1023) == 2);
+    assert("huge values land in the last bucket",
+        hist.buckets[HISTOGRAM_BUCKETS - 1] == 1);
+    assert("everything below the top",
+        histogram_count_le(&hist, UINT64_MAX) == 4);
+}
+
+Test(metrics_opcode, names_round_trip)
+{
+    size_t look = metrics_opcode("Look");
+
+    assert("known command", look < METRICS_OPCODE_HANDSHAKE);
+    assert("name matches", !strcmp(metrics_opcode_name(look), "Look"));
+    assert("unknown command", metrics_opcode("Dance") == METRICS_OPCODE_OTHER);
+    assert("missing command", metrics_opcode(nullptr) == METRICS_OPCODE_OTHER);
+}
@@ -0,0 +1,53 @@
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "client/client.h"
+#include "host/host.h"
+#include "server.h"
+
+#include "compass.h"
+#include "sample_server.h"
+
+static
+bool start_match(server_t *srv, match_t *match)
+{
+    srv->is_hosted = true;
+    srv->is_running = true;
+    match->srv = srv;
+    if (pipe2(match->inbox, O_CLOEXEC | O_NONBLOCK) < 0
+        || !start_sample(srv))
+        return false;
+    srv->self_fd = match->inbox[0];
+    return true;
+}
+
+Test(host, match_adopts_handed_over_clients)
+{
+    server_t srv = { .self_fd = -1 };
+    match_t match = { };
+    handoff_t handoff = { .len = 3, .line = "red" };
+    int sv[2];
+    char reply[64] = { };
+
+    assert("match started", start_match(&srv, &match)
+        && socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    handoff.fd = sv[0];
+    assert("handed over", write(match.inbox[1], &handoff, sizeof handoff)
+        == sizeof handoff);
+    match_adopt_clients(&srv);
+    assert("joined its team", srv.cm.count == srv.cm.idx_of_players + 1
+        && srv.cm.clients[srv.cm.idx_of_players].team_id == 3);
+    flush_dirty_clients(&srv);
+    assert("not greeted twice", read(sv[1], reply, sizeof reply - 1) > 0
+        && strncmp(reply, "WELCOME", 7) != 0);
+    assert("stop order", match_order(&match, HANDOFF_STOP));
+    match_adopt_clients(&srv);
+    assert("stopped", !srv.is_running);
+    server_destroy(&srv);
+    close(match.inbox[1]);
+    close(sv[1]);
+}
@@ -0,0 +1,103 @@
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "client/client.h"
+#include "game_events/handler.h"
+#include "game_events/incantation.h"
+#include "server.h"
+
+#include "compass.h"
+#include "sample_server.h"
+
+static
+bool scalar_ready(const inventory_t *tile, uint8_t tier)
+{
+    for (size_t i = 0; i < RES_COUNT; i++)
+        if (tile->qnts[i] < INCANTATION_REQUIREMENTS[tier - 1]
+            .resources.qnts[i])
+            return false;
+    return true;
+}
+
+Test(incantation, vector_check_matches_scalar)
+{
+    inventory_t tile = { };
+    bool same = true;
+
+    srand(3);
+    for (size_t n = 0; n < 10000; n++) {
+        for (size_t i = 0; i < RES_COUNT; i++)
+            tile.qnts[i] = rand() % 4;
+        for (uint8_t tier = 1; tier < TIER_MAX; tier++)
+            same &= incantation_tile_ready(&tile, tier)
+                == scalar_ready(&tile, tier);
+    }
+    assert("same verdicts", same);
+}
+
+Test(incantation, tile_index_follows_players)
+{
+    server_t srv = { .self_fd = -1 };
+    client_state_t *player;
+    uint8_t x;
+    uint8_t y;
+
+    assert("sample started", start_sample(&srv));
+    player = join_sample_team(&srv, "red");
+    assert("player joined", player != nullptr && player->tier == 1);
+    x = player->x;
+    y = player->y;
+    srv.map[y][x].linemate = 1;
+    assert("tile ready", incantation_ready(&srv, x, y, 1));
+    assert("level 2 not ready", !incantation_ready(&srv, x, y, 2));
+    remove_client(&srv, player - srv.cm.clients);
+    assert("player counted out", srv.tile_players[y][x][1] == 0
+        && !incantation_ready(&srv, x, y, 1));
+    server_destroy(&srv);
+}
+
+Test(incantation, tile_index_follows_moves)
+{
+    server_t srv = { .self_fd = -1 };
+    client_state_t *player;
+    event_t forward = { .arg_count = 1 };
+    client_state_t before;
+
+    assert("sample started", start_sample(&srv));
+    player = join_sample_team(&srv, "red");
+    assert("player joined", player != nullptr);
+    before = *player;
+    forward.client_idx = player - srv.cm.clients;
+    forward.client_id = player->id;
+    player_move_forward_handler(&srv, &forward);
+    assert("counted out of the old tile",
+        srv.tile_players[before.y][before.x][1] == 0);
+    assert("counted on the new tile",
+        srv.tile_players[player->y][player->x][1] == 1);
+    server_destroy(&srv);
+}
+
+Test(incantation, team_tiers_follow_players)
+{
+    server_t srv = { .self_fd = -1 };
+    client_state_t *player;
+    event_t end = { };
+
+    assert("sample started", start_sample(&srv));
+    player = join_sample_team(&srv, "red");
+    assert("player joined", player != nullptr);
+    assert("counted in its team", srv.team_tiers[3][1] == 1
+        && srv.team_tiers[4][1] == 0);
+    srv.map[player->y][player->x].linemate = 1;
+    player->is_in_incantation = true;
+    end.client_idx = player - srv.cm.clients;
+    end.client_id = player->id;
+    player_end_incentation_handler(&srv, &end);
+    assert("counted in its new tier", player->tier == 2
+        && srv.team_tiers[3][1] == 0 && srv.team_tiers[3][2] == 1);
+    remove_client(&srv, player - srv.cm.clients);
+    assert("counted out", srv.team_tiers[3][2] == 0);
+    server_destroy(&srv);
+}
@@ -0,0 +1,51 @@
+#include <poll.h>
+#include <string.h>
+
+#include "client/client.h"
+#include "utils/buffer_pool.h"
+#include "server.h"
+
+#include "compass.h"
+#include "sample_server.h"
+
+static
+void feed(server_t *srv, uint32_t id, const char *line, size_t times)
+{
+    client_state_t *client = client_from_id(srv, id);
+    size_t len = strlen(line);
+
+    buffer_pool_reserve(&client->input, len * times);
+    for (size_t i = 0; i < times; i++) {
+        memcpy(client->input.buff + client->input.nmemb, line, len);
+        client->input.nmemb += len;
+    }
+}
+
+Test(intake, flood_is_spread_over_rounds)
+{
+    server_t srv = { .self_fd = -1 };
+    uint32_t flood;
+    uint32_t calm;
+    client_state_t *cl;
+
+    assert("server started", start_sample(&srv));
+    flood = join_sample_team(&srv, "red")->id;
+    calm = join_sample_team(&srv, "blue")->id;
+    feed(&srv, flood, "Left\n", 25);
+    feed(&srv, calm, "Right\n", 2);
+    process_clients_buff(&srv);
+    cl = client_from_id(&srv, flood);
+    assert("flood held to the budget", cl->intake_lines
+        == INTAKE_LINE_BUDGET && cl->intake_budget_hits == 1);
+    assert("flood not read from", srv.intake_backlog
+        && !(srv.cm.server_pfds[cl - srv.cm.clients].events & POLLIN));
+    assert("calm client served", client_from_id(&srv, calm)->intake_lines
+        == 2);
+    process_clients_buff(&srv);
+    process_clients_buff(&srv);
+    cl = client_from_id(&srv, flood);
+    assert("flood drained", cl->intake_lines == 25 && !srv.intake_backlog);
+    assert("flood read again",
+        srv.cm.server_pfds[cl - srv.cm.clients].events & POLLIN);
+    server_destroy(&srv);
+}
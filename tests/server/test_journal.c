@@ -0,0 +1,116 @@
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "journal/journal_reader.h"
+#include "server.h"
+
+#include "compass.h"
+#include "sample_server.h"
+
+static
+bool write_sample(const char *path)
+{
+    params_t p = sample_params();
+    server_t srv = { .start_time = 2000 };
+
+    p.journal_path = path;
+    if (!journal_start(&srv, &p, 1000))
+        return false;
+    journal_event(srv.journal, JOURNAL_CONNECT, 4, 0);
+    journal_command(srv.journal, 4, "Look", 4);
+    journal_event(srv.journal, JOURNAL_FIRE, 4, 9);
+    journal_close(srv.journal);
+    return true;
+}
+
+Test(journal, header_round_trip)
+{
+    char path[] = "/tmp/zappy_journal_XXXXXX";
+    journal_reader_t reader = { };
+
+    close(mkstemp(path));
+    assert("journal written", write_sample(path));
+    assert("journal read back", journal_reader_open(&reader, path));
+    assert("world kept", reader.header.map_height == 12
+        && reader.header.seed == 7 && reader.header.booted_at == 2000);
+    assert("teams kept", reader.header.team_count == 5
+        && !strcmp(reader.teams[4], "blue") && reader.teams[5] == nullptr);
+    journal_reader_close(&reader);
+    unlink(path);
+}
+
+Test(journal, records_round_trip)
+{
+    char path[] = "/tmp/zappy_journal_XXXXXX";
+    journal_reader_t reader = { };
+    journal_record_t record;
+    const char *payload;
+
+    close(mkstemp(path));
+    write_sample(path);
+    journal_reader_open(&reader, path);
+    assert("connect", journal_reader_next(&reader, &record) != nullptr
+        && record.type == JOURNAL_CONNECT && record.client_id == 4);
+    payload = journal_reader_next(&reader, &record);
+    assert("command", payload != nullptr && record.type == JOURNAL_COMMAND
+        && record.length == 4 && !memcmp(payload, "Look", 4));
+    assert("fire", journal_reader_next(&reader, &record) != nullptr
+        && record.type == JOURNAL_FIRE && record.opcode == 9);
+    assert("end", journal_reader_next(&reader, &record) == nullptr);
+    journal_reader_close(&reader);
+    unlink(path);
+}
+
+Test(journal, rejects_foreign_file)
+{
+    char path[] = "/tmp/zappy_journal_XXXXXX";
+    int fd = mkstemp(path);
+    journal_reader_t reader = { };
+
+    assert("garbage written", write(fd, "not a journal at all, clearly", 30)
+        == 30);
+    close(fd);
+    assert("garbage rejected", !journal_reader_open(&reader, path));
+    unlink(path);
+}
+
+Test(journal, rejects_out_of_range_header)
+{
+    char path[] = "/tmp/zappy_journal_XXXXXX";
+    int fd = mkstemp(path);
+    const char names[] = "-SERVER\0-UNASSIGNED\0GRAPHIC\0red";
+    journal_header_t header = { .version = JOURNAL_VERSION,
+        .frequency = 100, .map_width = 200, .map_height = 200,
+        .team_capacity = 3, .team_count = 4, .names_size = sizeof names };
+    journal_reader_t reader = { };
+
+    memcpy(header.magic, JOURNAL_MAGIC, sizeof JOURNAL_MAGIC);
+    assert("journal written", write(fd, &header, sizeof header)
+        == sizeof header && write(fd, names, sizeof names) == sizeof names);
+    close(fd);
+    assert("oversized map rejected", !journal_reader_open(&reader, path));
+    unlink(path);
+}
+
+Test(journal, simultaneous_events_fire_in_push_order)
+{
+    event_heap_t heap;
+    event_t event = { .timestamp = 10, .command = { "Look" } };
+
+    event_heap_init(&heap);
+    for (int id = 0; id < 16; id++) {
+        event.client_id = id;
+        event.timestamp = (id % 3 == 0) ? 5 : 10;
+        event_heap_push(&heap, &event);
+    }
+    for (int id = 0; id < 16; id += 3, event_heap_pop(&heap))
+        assert("early events first, in order",
+            event_heap_peek(&heap)->client_id == id);
+    for (int id = 1; id < 16; id += 1 + (id % 3 == 2), event_heap_pop(&heap))
+        assert("late events next, in order",
+            event_heap_peek(&heap)->client_id == id);
+    event_heap_free(&heap);
+}
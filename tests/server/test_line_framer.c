@@ -0,0 +1,97 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "client/client.h"
+#include "utils/buffer_pool.h"
+
+#include "compass.h"
+
+static
+void feed(client_state_t *client, const char *data)
+{
+    size_t len = strlen(data);
+
+    buffer_pool_reserve(&client->input, len);
+    memcpy(client->input.buff + client->input.nmemb, data, len);
+    client->input.nmemb += len;
+}
+
+Test(line_framer, splits_complete_lines)
+{
+    client_state_t client = { };
+    size_t len = 0;
+    char *line;
+
+    feed(&client, "Look\nForward\n");
+    line = client_next_line(&client, &len);
+    assert("first line", line != nullptr && !strcmp(line, "Look"));
+    assert("first line length", len == 4);
+    line = client_next_line(&client, &len);
+    assert("second line", line != nullptr && !strcmp(line, "Forward"));
+    assert("nothing left", client_next_line(&client, &len) == nullptr);
+    client_input_compact(&client);
+    assert("buffer recycled", client.input.nmemb == 0);
+    buffer_pool_drop(&client.input);
+}
+
+Test(line_framer, keeps_partial_line)
+{
+    client_state_t client = { };
+    size_t len = 0;
+    char *line;
+
+    feed(&client, "Loo");
+    assert("partial line is not a command",
+        client_next_line(&client, &len) == nullptr);
+    assert("partial bytes were scanned", client.in_scan_idx == 3);
+    client_input_compact(&client);
+    feed(&client, "k\nRi");
+    line = client_next_line(&client, &len);
+    assert("line completed", line != nullptr && !strcmp(line, "Look"));
+    assert("trailing partial line",
+        client_next_line(&client, &len) == nullptr);
+    client_input_compact(&client);
+    assert("partial line moved to front",
+        client.input.nmemb == 2 && !memcmp(client.input.buff, "Ri", 2));
+    buffer_pool_drop(&client.input);
+}
+
+Test(line_framer, drops_oversized_line)
+{
+    client_state_t client = { };
+    char *chunk = malloc(CLIENT_MAX_LINE_LEN + 2);
+    size_t len = 42;
+    char *line;
+
+    memset(chunk, 'a', CLIENT_MAX_LINE_LEN + 1);
+    chunk[CLIENT_MAX_LINE_LEN + 1] = '\0';
+    feed(&client, chunk);
+    assert("no line yet", client_next_line(&client, &len) == nullptr);
+    assert("buffer does not grow", client.input.nmemb == 0);
+    feed(&client, "aaaa\nLook\n");
+    line = client_next_line(&client, &len);
+    assert("oversized line is emptied", line != nullptr && len == 0);
+    line = client_next_line(&client, &len);
+    assert("framing resumes", line != nullptr && !strcmp(line, "Look"));
+    buffer_pool_drop(&client.input);
+    free(chunk);
+}
+
+Test(line_framer, empties_oversized_complete_line)
+{
+    client_state_t client = { };
+    char *chunk = malloc(CLIENT_MAX_LINE_LEN + 3);
+    size_t len = 42;
+    char *line;
+
+    memset(chunk, 'a', CLIENT_MAX_LINE_LEN + 1);
+    strcpy(chunk + CLIENT_MAX_LINE_LEN + 1, "\n");
+    feed(&client, chunk);
+    feed(&client, "Look\n");
+    line = client_next_line(&client, &len);
+    assert("oversized line is emptied", line != nullptr && len == 0);
+    line = client_next_line(&client, &len);
+    assert("next line intact", line != nullptr && !strcmp(line, "Look"));
+    buffer_pool_drop(&client.input);
+    free(chunk);
+}
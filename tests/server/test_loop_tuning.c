@@ -0,0 +1,29 @@
+#include "server.h"
+
+#include "compass.h"
+
+Test(loop_tuning, parses_every_key)
+{
+    loop_tuning_t tuning;
+
+    assert("parsed", loop_tuning_parse("cpu=2-5,fifo=40,nice=3,mlock",
+        &tuning));
+    assert("cpu range", tuning.cpu_first == 2 && tuning.cpu_last == 5);
+    assert("priorities", tuning.fifo_priority == 40
+        && tuning.nice_boost == 3);
+    assert("mlock", tuning.mlock);
+    assert("single cpu", loop_tuning_parse("cpu=7", &tuning)
+        && tuning.cpu_first == 7 && tuning.cpu_last == 7
+        && tuning.fifo_priority == 0 && !tuning.mlock);
+}
+
+Test(loop_tuning, rejects_bad_specs)
+{
+    loop_tuning_t tuning;
+
+    assert("unknown key", !loop_tuning_parse("turbo", &tuning));
+    assert("reversed range", !loop_tuning_parse("cpu=5-2", &tuning));
+    assert("priority range", !loop_tuning_parse("fifo=100", &tuning));
+    assert("missing value", !loop_tuning_parse("nice", &tuning));
+    assert("value on a flag", !loop_tuning_parse("mlock=1", &tuning));
+}
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "client/client.h"
+#include "game_events/handler.h"
+#include "game_events/map_resources.h"
+#include "server.h"
+#include "utils/common_macros.h"
+
+#include "compass.h"
+#include "sample_server.h"
+
+static
+bool count_holds(server_t *srv)
+{
+    inventory_t found = map_resources_count(srv);
+
+    return !memcmp(&found, &srv->total_item_in_map, sizeof found);
+}
+
+static
+void run_object(server_t *srv, client_state_t *player, char *verb,
+    char *object)
+{
+    event_t event = { .arg_count = 2, .command = { verb, object } };
+
+    event.client_idx = player - srv->cm.clients;
+    event.client_id = player->id;
+    if (verb[0] == 'T')
+        player_take_object_handler(srv, &event);
+    else
+        player_set_object_handler(srv, &event);
+}
+
+Test(map_resources, sum_matches_scalar)
+{
+    inventory_t tiles[37] = { };
+    inventory_t expected = { };
+    inventory_t sum;
+
+    srand(5);
+    for (size_t i = 0; i < LENGTH_OF(tiles); i++)
+        for (size_t k = 0; k < RES_COUNT; k++) {
+            tiles[i].qnts[k] = rand() % 9;
+            expected.qnts[k] += tiles[i].qnts[k];
+        }
+    sum = inventory_sum(tiles, LENGTH_OF(tiles));
+    assert("same sums", !memcmp(&sum, &expected, sizeof sum));
+}
+
+Test(map_resources, count_follows_every_change)
+{
+    server_t srv = { .self_fd = -1 };
+    client_state_t *player;
+    event_t end = { };
+
+    assert("server started", start_sample(&srv));
+    game_meteor_handler(&srv, &(event_t){ });
+    assert("meteor counted", count_holds(&srv)
+        && srv.total_item_in_map.food != 0);
+    player = join_sample_team(&srv, "red");
+    map_resource_add(&srv, &srv.map[player->y][player->x], 1, 2);
+    run_object(&srv, player, "Take", "linemate");
+    assert("take counted", count_holds(&srv) && player->inv.linemate == 1);
+    run_object(&srv, player, "Set", "food");
+    assert("set counted", count_holds(&srv));
+    player->is_in_incantation = true;
+    end.client_idx = player - srv.cm.clients;
+    end.client_id = player->id;
+    player_end_incentation_handler(&srv, &end);
+    assert("incantation counted", player->tier == 2 && count_holds(&srv));
+    server_destroy(&srv);
+}
@@ -0,0 +1,39 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "proto_writer.h"
+
+#include "compass.h"
+
+static const uint32_t SAMPLES[] = {
+    0, 7, 9, 10, 42, 99, 100, 101, 999, 1000, 65535, 123456789,
+    999999999, 1000000000, 4294967295
+};
+
+Test(proto_writer, numbers_match_printf)
+{
+    char written[16];
+    char expected[16];
+
+    for (size_t i = 0; i < sizeof SAMPLES / sizeof *SAMPLES; i++) {
+        *proto_u32(written, SAMPLES[i]) = '\0';
+        snprintf(expected, sizeof expected, "%u", SAMPLES[i]);
+        assert("same digits", !strcmp(written, expected));
+    }
+}
+
+Test(proto_writer, messages_match_the_protocol)
+{
+    char msg[2 * PROTO_TILE_MSG_MAX_LEN];
+    inventory_t inv = { .qnts = { 10, 0, 3, 12, 1, 0, 250 } };
+    char *end;
+
+    *proto_ppo(msg, 17, (uint8_t []){ 4, 41 }, 2) = '\0';
+    assert("ppo", !strcmp(msg, "ppo #17 4 41 3\n"));
+    *proto_plv(msg, 3, 8) = '\0';
+    assert("plv", !strcmp(msg, "plv #3 8\n"));
+    end = proto_pin(msg, 5, (uint8_t []){ 0, 9 }, &inv);
+    *proto_bct(end, 0, 9, &inv) = '\0';
+    assert("pin then bct", !strcmp(msg,
+        "pin #5 0 9 10 0 3 12 1 0 250\nbct 0 9 10 0 3 12 1 0 250\n"));
+}
@@ -0,0 +1,87 @@
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "client/client.h"
+#include "server.h"
+
+#include "compass.h"
+#include "sample_server.h"
+
+static
+params_t restore_params(const char *path)
+{
+    params_t p = sample_params();
+
+    p.restore_path = path;
+    return p;
+}
+
+static
+bool write_sample(server_t *srv, const char *path)
+{
+    if (!start_sample(srv) || join_sample_team(srv, "blue") == nullptr)
+        return false;
+    return snapshot_write(srv, path, get_timestamp());
+}
+
+static
+bool restore_sample(server_t *srv, snapshot_reader_t *reader, params_t *p)
+{
+    return snapshot_reader_open(reader, p) && p->map_height == 12
+        && !strcmp(p->teams[4], "blue") && server_start(srv, p)
+        && snapshot_restore(srv, reader);
+}
+
+static
+bool same_player(const client_state_t *a, const client_state_t *b)
+{
+    return a->id == b->id && a->team_id == b->team_id && a->x == b->x
+        && a->y == b->y && a->tier == b->tier && b->fd == -1
+        && !memcmp(&a->inv, &b->inv, sizeof a->inv);
+}
+
+static
+bool same_depth(const event_queue_t *a, const event_queue_t *b)
+{
+    return event_queue_depth(a) == event_queue_depth(b);
+}
+
+Test(snapshot, round_trip)
+{
+    char path[] = "/tmp/zappy_snapshot_XXXXXX";
+    server_t srv = { .self_fd = -1 };
+    server_t copy = { .self_fd = -1 };
+    snapshot_reader_t reader = { };
+    params_t p = restore_params(path);
+
+    close(mkstemp(path));
+    assert("snapshot written", write_sample(&srv, path));
+    assert("snapshot restored", restore_sample(&copy, &reader, &p));
+    assert("world kept", !memcmp(srv.map, copy.map, sizeof srv.map)
+        && srv.eggs.nmemb == copy.eggs.nmemb
+        && srv.eggs.buff[4].x == copy.eggs.buff[4].x);
+    assert("player kept", copy.cm.count == copy.cm.idx_of_players + 1
+        && same_player(srv.cm.clients + srv.cm.idx_of_players,
+            copy.cm.clients + copy.cm.idx_of_players));
+    assert("events kept", same_depth(&srv.events, &copy.events));
+    server_destroy(&srv);
+    server_destroy(&copy);
+    snapshot_reader_close(&reader);
+    unlink(path);
+}
+
+Test(snapshot, rejects_foreign_file)
+{
+    char path[] = "/tmp/zappy_snapshot_XXXXXX";
+    int fd = mkstemp(path);
+    snapshot_reader_t reader = { };
+    params_t p = restore_params(path);
+
+    assert("garbage written", write(fd, "not a snapshot, clearly", 23) == 23);
+    close(fd);
+    assert("garbage rejected", !snapshot_reader_open(&reader, &p));
+    unlink(path);
+}
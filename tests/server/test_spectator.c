@@ -0,0 +1,85 @@
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "client/client.h"
+#include "server.h"
+#include "spectator/spectator.h"
+
+#include "compass.h"
+#include "sample_server.h"
+
+static
+feed_t tile_record(uint32_t n)
+{
+    return (feed_t){ .type = FEED_TILE, .x = n % 10, .y = 3,
+        .tile = {{ .food = n, .thystame = n * 3 }} };
+}
+
+static
+bool stream_tiles(server_t *srv, spectator_t *spec, feed_t *last)
+{
+    bool pushed = true;
+
+    for (uint32_t n = 0; n < 3 * SPECTATOR_RING_SIZE / sizeof *last; n++) {
+        *last = tile_record(n);
+        pushed &= spectator_ring_push(spec, last, nullptr);
+        if (n % 1000 == 999) {
+            spectator_ring_publish(spec);
+            spectator_ring_drain(srv, spec->ring);
+        }
+    }
+    spectator_ring_publish(spec);
+    spectator_ring_drain(srv, spec->ring);
+    return pushed && !spec->overflowed;
+}
+
+Test(spectator, ring_wraps_around)
+{
+    server_t srv = { .self_fd = -1 };
+    spectator_t spec = { .ring = spectator_ring_create(),
+        .event_fd = eventfd(0, EFD_NONBLOCK) };
+    feed_t last;
+
+    assert("world started", start_sample(&srv) && spec.ring != nullptr);
+    assert("every record fit", stream_tiles(&srv, &spec, &last));
+    assert("last tile applied", !memcmp(&srv.map[3][last.x], &last.tile,
+        sizeof last.tile));
+    server_destroy(&srv);
+    munmap(spec.ring, sizeof *spec.ring);
+    close(spec.event_fd);
+}
+
+Test(spectator, ring_overflows_without_observer)
+{
+    spectator_t spec = { .ring = spectator_ring_create() };
+    feed_t record = { .type = FEED_FORK, .id = 1 };
+    size_t count = 0;
+
+    while (spectator_ring_push(&spec, &record, nullptr))
+        count++;
+    assert("ring filled",
+        count == SPECTATOR_RING_SIZE / ((sizeof record + 7) & ~7));
+    assert("overflow flagged", spec.overflowed);
+    munmap(spec.ring, sizeof *spec.ring);
+}
+
+Test(spectator, inline_feed_keeps_gui_messages)
+{
+    server_t srv = { .self_fd = -1 };
+    client_state_t *gui;
+    feed_t object = { .type = FEED_OBJECT, .id = 4, .x = 1, .y = 2,
+        .inv = {{ .food = 9 }}, .tile = {{ .sibur = 2 }} };
+
+    assert("world started", start_sample(&srv));
+    gui = join_sample_team(&srv, "GRAPHIC");
+    gui_feed(&srv, &(feed_t){ .type = FEED_BROADCAST, .id = 7 }, "hi");
+    gui_feed(&srv, &object, nullptr);
+    assert("pbc sent", strstr(gui->output.buff, "pbc #7 hi\n") != nullptr);
+    assert("pin and bct sent", strstr(gui->output.buff,
+        "pin #4 1 2 9 0 0 0 0 0 0\nbct 1 2 0 0 0 2 0 0 0\n") != nullptr);
+    server_destroy(&srv);
+}
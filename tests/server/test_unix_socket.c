@@ -0,0 +1,77 @@
+#define _GNU_SOURCE
+
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "client/client.h"
+#include "server.h"
+
+#include "compass.h"
+#include "sample_server.h"
+
+static
+int connect_to(const char *path)
+{
+    struct sockaddr_un sa = { .sun_family = AF_UNIX };
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    strcpy(sa.sun_path, path);
+    if (fd >= 0 && connect(fd, (struct sockaddr *)&sa, sizeof sa) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+Test(unix_socket, replaces_stale_socket)
+{
+    char path[64];
+    int first;
+    int second;
+
+    snprintf(path, sizeof path, "/tmp/zappy_test_%d.sock", getpid());
+    first = server_socket_listen_unix(path, 4);
+    close(first);
+    second = server_socket_listen_unix(path, 4);
+    assert("stale socket replaced", first >= 0 && second >= 0);
+    close(second);
+    unlink(path);
+}
+
+static
+bool listen_both(server_t *srv, const char *game, const char *local)
+{
+    srv->self_fd = server_socket_listen_unix(game, 4);
+    srv->unix_fd = server_socket_listen_unix(local, 4);
+    srv->unix_path = local;
+    srv->cm.server_pfds[0].fd = server_socket_watch(srv->self_fd,
+        srv->unix_fd);
+    return srv->cm.server_pfds[0].fd >= 0;
+}
+
+Test(unix_socket, accepts_from_both_listeners)
+{
+    server_t srv = { .self_fd = -1 };
+    char game[64];
+    char local[64];
+    int clients[2];
+
+    snprintf(game, sizeof game, "/tmp/zappy_game_%d.sock", getpid());
+    snprintf(local, sizeof local, "/tmp/zappy_local_%d.sock", getpid());
+    assert("world started", start_sample(&srv));
+    assert("listening", listen_both(&srv, game, local));
+    clients[0] = connect_to(game);
+    clients[1] = connect_to(local);
+    add_client(&srv);
+    assert("both accepted", srv.accept_stats.accepted == 2
+        && srv.cm.count == 3);
+    server_destroy(&srv);
+    assert("socket file removed", access(local, F_OK) < 0);
+    close(clients[0]);
+    close(clients[1]);
+    unlink(game);
+}